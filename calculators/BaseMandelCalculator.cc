@@ -9,14 +9,127 @@
 #include <vector>
 #include <algorithm>
 
+#include <stdlib.h>
+
 #include "BaseMandelCalculator.h"
 
 BaseMandelCalculator::BaseMandelCalculator(unsigned matrixBaseSize, unsigned limit, const std::string &cName)
-	: width(3 * matrixBaseSize), height(2 * matrixBaseSize), x_start(-2.0), x_fin(1.0), y_start(-1.5), y_fin(1.5), limit(limit), cName(cName)
+	: BaseMandelCalculator(3 * matrixBaseSize, 2 * matrixBaseSize, limit, cName)
+{
+}
+
+BaseMandelCalculator::BaseMandelCalculator(unsigned width, unsigned height, unsigned limit, const std::string &cName)
+	: width(width), height(height), x_start(-2.0), x_fin(1.0), y_start(-1.5), y_fin(1.5), limit(limit), cName(cName)
+
+{
+	dx = (x_fin - x_start) / (width - 1);
+	dy = (y_fin - y_start) / (height - 1);
+
+	// The own buffer is allocated by the first calculateMandelbrot without an external one.
+	data = NULL;
+	ownsData = false;
+	ownedRows = 0;
+	rowOffset = 0;
+	symmetric = true;
+	halfOutput = false;
+	reportedRows = 0;
+	control = NULL;
+}
+
+BaseMandelCalculator::~BaseMandelCalculator()
+{
+	if (ownsData)
+		freeBuffer(data);
+	data = NULL;
+}
+
+void BaseMandelCalculator::setOutputBuffer(int *buffer)
+{
+	if (ownsData)
+		freeBuffer(data);
+	data = buffer;
+	ownsData = false;
+	ownedRows = 0;
+}
+
+void BaseMandelCalculator::allocateOutput()
+{
+	if (data && (!ownsData || ownedRows >= height))
+		return;
 
+	if (ownsData)
+		freeBuffer(data);
+	data = NULL;
+	data = allocArray<int>(static_cast<size_t>(height) * width);
+	ownsData = true;
+	ownedRows = height;
+}
+
+void BaseMandelCalculator::setViewport(double xStart, double xFin, double yStart, double yFin)
 {
+	x_start = xStart;
+	x_fin = xFin;
+	y_start = yStart;
+	y_fin = yFin;
+
 	dx = (x_fin - x_start) / (width - 1);
 	dy = (y_fin - y_start) / (height - 1);
+	symmetric = y_start == -y_fin;
+}
+
+void BaseMandelCalculator::setRowWindow(int firstRow, int rows)
+{
+	rowOffset = firstRow;
+	height = rows;
+	symmetric = false;
+}
+
+void BaseMandelCalculator::setHalfOutput(bool half)
+{
+	halfOutput = half;
+}
+
+void BaseMandelCalculator::setRowCallback(RowCallback callback)
+{
+	rowCallback = callback;
+	reportedRows = 0;
+}
+
+void BaseMandelCalculator::setRenderControl(RenderControl *control)
+{
+	this->control = control;
+}
+
+void BaseMandelCalculator::rowsComputed(int rows)
+{
+	if (!control)
+		return;
+
+	control->computedRows.fetch_add(rows, std::memory_order_relaxed);
+	checkCancelled();
+}
+
+void BaseMandelCalculator::rowsFinished(int endRow)
+{
+	if (!rowCallback || endRow <= reportedRows)
+		return;
+
+	rowCallback(data + static_cast<size_t>(reportedRows) * width, reportedRows, endRow);
+	reportedRows = endRow;
+}
+
+void BaseMandelCalculator::finishRows()
+{
+	rowsFinished(storedRows());
+	reportedRows = 0;
+}
+
+int BaseMandelCalculator::referenceValue(int i, int j) const
+{
+	float x = x_start + j * dx; // current real value
+	float y = y_start + (rowOffset + i) * dy; // current imaginary value
+
+	return mandelbrot(x, y, limit);
 }
 
 void BaseMandelCalculator::info(std::ostream &cout, bool batchMode)
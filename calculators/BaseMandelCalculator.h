@@ -11,6 +11,32 @@
 
 #include <string>
 #include <iostream>
+#include <functional>
+#include <atomic>
+#include <stdexcept>
+
+#include <buffer_alloc.h>
+
+/**
+ * @brief Thrown out of calculateMandelbrot when its render was cancelled
+ */
+class RenderCancelled : public std::runtime_error
+{
+public:
+    RenderCancelled() : std::runtime_error("Render cancelled") {}
+};
+
+/**
+ * @brief State shared with a render running in another thread: cancellation and progress
+ */
+struct RenderControl
+{
+    std::atomic<bool> cancelled; // set to stop the render at the next row (or block)
+    std::atomic<unsigned long long> computedRows; // rows iterated so far, mirrored ones are not counted
+    std::atomic<unsigned long long> totalRows; // rows the render iterates, 0 until it starts
+
+    RenderControl() : cancelled(false), computedRows(0), totalRows(0) {}
+};
 
 /**
  * @brief Abstract class for Mandelbrot set calculator, calculates the dimensions
@@ -27,29 +53,198 @@ public:
      * @param cName name of the calculator
      */
     BaseMandelCalculator(unsigned matrixBaseSize, unsigned limit, const std::string & cName);
+
+    /**
+     * @brief Construct a new Base Mandel Calculator object of arbitrary dimensions
+     *
+     * @param width number of columns
+     * @param height number of rows
+     * @param limit number of iterations
+     * @param cName name of the calculator
+     */
+    BaseMandelCalculator(unsigned width, unsigned height, unsigned limit, const std::string & cName);
+    virtual ~BaseMandelCalculator();
+
+    /**
+     * @brief Computes the set into the output buffer
+     *
+     * @return the output buffer (height * width iteration counts)
+     */
+    virtual int * calculateMandelbrot() = 0;
     
+    /**
+     * @brief Number of rows calculateMandelbrot iterates, the others are mirrored
+     *
+     * A band is computed whole, the full set only up to the middle row and mirrored.
+     */
+    virtual int computedRows() const { return symmetric ? height / 2 + 1 : height; }
+
     /**
      * @brief Prints output to ostream 
      * 
      * @param cout output stream
      * @param batchMode true = compact CSV output
      */
-    void info(std::ostream & cout, bool batchMode);
+    virtual void info(std::ostream & cout, bool batchMode);
+
+    /**
+     * @brief Makes the calculator compute into an external buffer instead of its own one
+     *
+     * @param buffer height * width integers, owned by the caller and valid while the calculator is used
+     */
+    void setOutputBuffer(int * buffer);
+
+    /**
+     * @brief Changes the computed part of the complex plane (default x -2..1, y -1.5..1.5)
+     *
+     * Only a viewport symmetric around the real axis is computed as a mirrored half.
+     * Has to be called before setRowWindow.
+     */
+    virtual void setViewport(double xStart, double xFin, double yStart, double yFin);
+
+    /**
+     * @brief Restricts the computation to a horizontal band of the set
+     *
+     * The band is computed directly (the symmetry of the set is not used) into the first
+     * rows * width integers of the output buffer, height becomes the band height.
+     *
+     * @param firstRow first row of the band in the whole set
+     * @param rows number of rows of the band
+     */
+    void setRowWindow(int firstRow, int rows);
+
+    /**
+     * @brief Keeps a symmetric set as its upper half, the calculator does not mirror it
+     *
+     * Only storedRows() rows are written (and reported to the row callback), row i >= storedRows()
+     * of the image is row height - i - 1, see SymmetricRows.
+     */
+    void setHalfOutput(bool half);
+
+    /**
+     * @brief Number of rows written to the output buffer
+     */
+    int storedRows() const { return symmetric && halfOutput ? computedRows() : height; }
+
+    /**
+     * @brief Computes one point with the scalar reference algorithm
+     *
+     * @param i row of the point
+     * @param j column of the point
+     * @return number of iterations before the point escaped (limit if it did not)
+     */
+    int referenceValue(int i, int j) const;
+
+    /**
+     * @brief Called with final rows [firstRow, lastRow) as soon as the calculator will not touch them again
+     *
+     * @param rows pointer to the first of the reported rows
+     */
+    typedef std::function<void(const int *rows, int firstRow, int lastRow)> RowCallback;
+
+    /**
+     * @brief Lets a consumer (e.g. a tile writer) stream the result while it is being computed
+     *
+     * Rows are reported in order, every row exactly once per calculateMandelbrot call.
+     */
+    void setRowCallback(RowCallback callback);
+
+    /**
+     * @brief Lets another thread cancel the computation and watch its progress
+     *
+     * A cancelled calculateMandelbrot throws RenderCancelled and leaves the buffer partially computed.
+     *
+     * @param control valid while the calculator is used, NULL = no control
+     */
+    void setRenderControl(RenderControl * control);
     
     int width; // width of the set
     int height; // hegiht of the set
 
 
 protected:
+    /**
+     * @brief Scalar reference iteration of one point
+     */
+    template <typename T>
+    static inline int mandelbrot(T real, T imag, int limit)
+    {
+        T zReal = real;
+        T zImag = imag;
+
+        for (int i = 0; i < limit; ++i)
+        {
+            T r2 = zReal * zReal;
+            T i2 = zImag * zImag;
+
+            if (r2 + i2 > 4.0f)
+                return i;
+
+            zImag = 2.0f * zReal * zImag + imag;
+            zReal = r2 - i2 + real;
+        }
+        return limit;
+    }
+
+    /**
+     * @brief Throws RenderCancelled if the render was cancelled, cheap enough to be called between blocks
+     */
+    void checkCancelled() const
+    {
+        if (control && control->cancelled.load(std::memory_order_relaxed))
+            throw RenderCancelled();
+    }
+
+    /**
+     * @brief Adds computed rows to the progress and checks the cancellation, called between rows
+     */
+    void rowsComputed(int rows = 1);
+
+    /**
+     * @brief True if the computed upper half is copied to the lower one
+     */
+    bool mirrorHalf() const { return symmetric && !halfOutput; }
+
+    /**
+     * @brief Reports all rows below endRow that were not reported yet
+     */
+    void rowsFinished(int endRow);
+
+    /**
+     * @brief Reports the remaining rows, called at the end of calculateMandelbrot
+     */
+    void finishRows();
+
+    /**
+     * @brief Allocates the own output buffer of height rows unless an external one was set,
+     *        called at the start of calculateMandelbrot
+     *
+     * A calculator rendering a row window into an external buffer never holds the whole image.
+     */
+    void allocateOutput();
+
+    int *data; // output matrix, NULL until allocateOutput or setOutputBuffer
+    bool ownsData; // false if data was supplied by setOutputBuffer
+    int ownedRows; // rows of the own buffer
+
     const std::string cName;
     const int limit;
     bool batchMode;
 
+    int rowOffset; // row of the whole set stored in the first row of data
+    bool symmetric; // true = only the upper half is computed and mirrored
+    bool halfOutput; // true = the upper half of a symmetric set is not mirrored
+
+    RowCallback rowCallback;
+    int reportedRows; // rows already passed to rowCallback
+
+    RenderControl *control; // cancellation and progress, NULL if not controlled
+
 
-	const double x_start; // minimal real value
-	const double x_fin; // maximal real value
-	const double y_start; // minimal imag value
-	const double y_fin; // maximal imag value
+	double x_start; // minimal real value
+	double x_fin; // maximal real value
+	double y_start; // minimal imag value
+	double y_fin; // maximal imag value
 	
     double dx; // step of real vaues
 	double dy; // step of imag values
@@ -16,98 +16,262 @@
 
 #include "BatchMandelCalculator.h"
 
+// Number of columns (and rows) in one cache block.
+static constexpr int block_size = 64;
+
+// Number of iterations between two checks whether the whole block has escaped.
+// All specialized limits have to be its multiples.
+static constexpr int escape_check_interval = 4;
+
+/**
+ * @brief Iterates one block of points in registers until all of them escape or the limit is hit
+ *
+ * @tparam LIMIT compile-time iteration limit, 0 = use the runtime limit
+ */
+template <int LIMIT>
+static void calculatePointBlock(const float *real, const float *imag, int *block_result, int block_width, int limit) {
+    static_assert(LIMIT % escape_check_interval == 0, "Specialized limit must be a multiple of the check interval");
+
+    // The limit is a compile-time constant for the specialized kernels.
+    const int current_limit = (LIMIT > 0) ? LIMIT : limit;
+    // The runtime kernel cannot know if the limit is divisible, so it checks every iteration.
+    constexpr int check_interval = (LIMIT > 0) ? escape_check_interval : 1;
+
+    // The whole block is loaded once, iterated in registers and stored once.
+    alignas(64) float c_real[block_size];
+    alignas(64) float c_imag[block_size];
+    alignas(64) float z_real[block_size];
+    alignas(64) float z_imag[block_size];
+    alignas(64) int result[block_size];
+
+    // Lanes past the last point are marked as already escaped.
+    #pragma omp simd simdlen(64)
+    for (int j = 0; j < block_size; j++) {
+        c_real[j] = (j < block_width) ? real[j] : 0.0f;
+        c_imag[j] = (j < block_width) ? imag[j] : 0.0f;
+        z_real[j] = c_real[j];
+        z_imag[j] = c_imag[j];
+        result[j] = (j < block_width) ? current_limit : 0;
+    }
+
+    // Set the count to block width. If for all columns the r2 + i2 value is greater
+    // than 4.0f, then the value at the end of the loop (k) will be zero.
+    int count = block_width;
+
+    for (int k = 0; k < current_limit; k += check_interval) {
+        for (int u = 0; u < check_interval; u++) {
+
+            #pragma omp simd reduction(-: count) simdlen(64)
+            for (int j = 0; j < block_size; j++) {
+                if (result[j] == current_limit) {
+                    const float r2 = z_real[j] * z_real[j];
+                    const float i2 = z_imag[j] * z_imag[j];
+
+                    if (r2 + i2 > 4.0f) {
+                        result[j] = k + u;
+                        --count;
+                    } else {
+                        z_imag[j] = 2.0f * z_real[j] * z_imag[j] + c_imag[j];
+                        z_real[j] = r2 - i2 + c_real[j];
+                    }
+                }
+            }
+        }
+
+        // For all columns the r2 + i2 value is greater than 4.0f, then end the loop.
+        if (count == 0) {
+            break;
+        }
+    }
+
+    #pragma omp simd simdlen(64)
+    for (int j = 0; j < block_width; j++) {
+        block_result[j] = result[j];
+    }
+}
+
+// Kernels specialized for the common limits.
+static const struct {
+    int limit;
+    BatchMandelCalculator::PointKernel kernel;
+} kernels[] = {
+    {100, &calculatePointBlock<100>},
+    {256, &calculatePointBlock<256>},
+    {1000, &calculatePointBlock<1000>},
+    {4096, &calculatePointBlock<4096>},
+};
+
+BatchMandelCalculator::PointKernel BatchMandelCalculator::selectKernel(int limit, bool *specialized) {
+    for (const auto &entry : kernels) {
+        if (entry.limit == limit) {
+            *specialized = true;
+            return entry.kernel;
+        }
+    }
+
+    *specialized = false;
+    return &calculatePointBlock<0>;
+}
 
 BatchMandelCalculator::BatchMandelCalculator (unsigned matrixBaseSize, unsigned limit) :
-	BaseMandelCalculator(matrixBaseSize, limit, "BatchMandelCalculator")
+	BatchMandelCalculator(3 * matrixBaseSize, 2 * matrixBaseSize, limit)
+{
+}
+
+BatchMandelCalculator::BatchMandelCalculator (unsigned width, unsigned height, unsigned limit, bool tiled) :
+	BaseMandelCalculator(width, height, limit, "BatchMandelCalculator"), tiled(tiled), tile_band(NULL)
 {
-    data  = (int *)(_mm_malloc(height * width * sizeof(int), 64));
-    real_storage = (float *)(_mm_malloc(width * sizeof(float), 64));
-    imag_storage = (float *)(_mm_malloc(width * sizeof(float), 64));
+    if (tiled) {
+        tile_band = allocArray<int>(static_cast<size_t>(block_size) * width);
+    }
+
+    // Select the kernel with the limit compiled in, fall back to the runtime one.
+    blockKernel = selectKernel(this->limit, &specializedKernel);
 }
 
 BatchMandelCalculator::~BatchMandelCalculator() {
-    _mm_free(data);
-    data = NULL;
+    freeBuffer(tile_band);
+    tile_band = NULL;
+}
+
+void BatchMandelCalculator::info(std::ostream &cout, bool batchMode) {
+    BaseMandelCalculator::info(cout, batchMode);
+
+    if (!batchMode) {
+        cout << "Layout:            " << (tiled ? "tile-major 64x64 bands" : "row-major") << std::endl;
+        if (specializedKernel) {
+            cout << "Kernel:            limit-specialized <" << limit << ">" << std::endl;
+        } else {
+            cout << "Kernel:            generic (runtime limit)" << std::endl;
+        }
+    }
+}
+
+void BatchMandelCalculator::calculateBlock(int *block_data, int block_j_start, int block_j_end, float y) {
+    const int block_width = block_j_end - block_j_start;
+
+    alignas(64) float real[block_size];
+    alignas(64) float imag[block_size];
 
-    _mm_free(imag_storage);
-    imag_storage = NULL;
+    #pragma omp simd simdlen(64)
+    for (int j = 0; j < block_size; j++) {
+        real[j] = static_cast<float>(x_start + (block_j_start + j) * dx); // Current real value.
+        imag[j] = y;
+    }
 
-    _mm_free(real_storage);
-    real_storage = NULL;
+    blockKernel(real, imag, block_data, block_width, limit);
 }
 
+void BatchMandelCalculator::calculateTiledBand(int block_i_start, int block_i_end) {
+    const int band_rows = block_i_end - block_i_start;
+
+    for (int block_j_start = 0; block_j_start < width; block_j_start += block_size) {
+        const int block_j_end = std::min(block_j_start + block_size, width);
+        const int tile_width = block_j_end - block_j_start;
+        // All tiles before this one are block_size wide.
+        int *tile = tile_band + static_cast<size_t>(block_j_start) * band_rows;
+
+        for (int i = block_i_start; i < block_i_end; i++) {
+            const float y = static_cast<float>(y_start + (rowOffset + i) * dy); // Current imaginary value.
+
+            calculateBlock(tile + (i - block_i_start) * tile_width, block_j_start, block_j_end, y);
+        }
+
+        checkCancelled();
+    }
+}
+
+void BatchMandelCalculator::untileBand(int block_i_start, int block_i_end) {
+    const int band_rows = block_i_end - block_i_start;
+
+    for (int i = block_i_start; i < block_i_end; i++) {
+        int *row = data + static_cast<size_t>(i) * width;
+        int *mirror_row = mirrorHalf() ? data + static_cast<size_t>(height - i - 1) * width : NULL;
+
+        for (int block_j_start = 0; block_j_start < width; block_j_start += block_size) {
+            const int tile_width = std::min(block_size, width - block_j_start);
+            const int *tile_row = tile_band + static_cast<size_t>(block_j_start) * band_rows + (i - block_i_start) * tile_width;
+
+            #pragma omp simd simdlen(64) safelen(64)
+            for (int j = 0; j < tile_width; j++) {
+                row[block_j_start + j] = tile_row[j];
+            }
+
+            if (mirror_row) {
+                #pragma omp simd simdlen(64) safelen(64)
+                for (int j = 0; j < tile_width; j++) {
+                    mirror_row[block_j_start + j] = tile_row[j];
+                }
+            }
+        }
+
+        rowsComputed();
+    }
+}
+
+void BatchMandelCalculator::calculatePoints(const float *real, const float *imag, int *result, size_t count, int limit) {
+    bool specialized;
+    const PointKernel kernel = selectKernel(limit, &specialized);
+
+    for (size_t start = 0; start < count; start += block_size) {
+        const int block_width = static_cast<int>(std::min<size_t>(block_size, count - start));
+        kernel(real + start, imag + start, result + start, block_width, limit);
+    }
+}
 
 int * BatchMandelCalculator::calculateMandelbrot () {
-    constexpr int block_size = 64;
+    allocateOutput();
+
     constexpr float block_size_float = static_cast<float>(block_size);
     const int half_height = height / 2;
-
-    // Prefill the data array with a limit value.
-    #pragma omp simd simdlen(64) safelen(64)
-    for (int i = 0; i <= half_height * width; i++) {
-        data[i] = limit;
-    }
+    const int rows = computedRows();
+    // The mirror copy of the middle rows overwrites the rows from this one on.
+    const int last_final_row = mirrorHalf() ? height - half_height - 1 : rows;
 
     // Cache blocking - rows.
-    for (int block_i = 0; block_i < std::ceil(half_height / block_size_float); block_i++) {
-        const int block_i_start = block_i * block_size;
-        const int block_i_end = ((block_i_start + block_size) >= half_height) ? half_height + 1 : block_i_start + block_size;
+    for (int block_i_start = 0; block_i_start < rows; block_i_start += block_size) {
+        const int block_i_end = std::min(block_i_start + block_size, rows);
+
+        if (tiled) {
+            calculateTiledBand(block_i_start, block_i_end);
+            untileBand(block_i_start, block_i_end);
+            rowsFinished(std::min(block_i_end, last_final_row));
+            continue;
+        }
 
         for (int i = block_i_start; i < block_i_end; i++) {
             // The row index in the data array.
-            const int row_start = i * width;
+            const size_t row_start = static_cast<size_t>(i) * width;
 
-            const float y = static_cast<float>(y_start + i * dy); // Current imaginary value.
-
-            #pragma omp simd simdlen(64)
-            for (int j = 0; j < width; j++) {
-                real_storage[j] = static_cast<float>(x_start + j * dx); // Current real value.
-                imag_storage[j] = y;
-            }
+            const float y = static_cast<float>(y_start + (rowOffset + i) * dy); // Current imaginary value.
 
             // Cache blocking - columns.
             for (int block_j = 0; block_j < std::ceil(width / block_size_float); block_j++) {
                 const int block_j_start = block_j * block_size;
-                const int block_j_end = block_j_start + block_size;
-
-                // Set the count to block size. If for all columns the r2 + i2 value is greater
-                // than 4.0f, then the value at the end of the loop (j) will be zero.
-                int count = block_size;
-
-                for (int k = 0; k < limit; k++) {
-
-                    #pragma omp simd reduction(-: count) simdlen(64)
-                    for (int j = block_j_start; j < block_j_end; j++) {
-                        if (data[row_start + j] == static_cast<int>(limit)) {
-                            const float r2 = real_storage[j] * real_storage[j];
-                            const float i2 = imag_storage[j] * imag_storage[j];
-
-                            if (r2 + i2 > 4.0f) {
-                                data[row_start + j] = k;
-                                --count;
-                            } else {
-                                imag_storage[j] = 2.0f * real_storage[j] * imag_storage[j] + y;
-                                real_storage[j] = r2 - i2 + static_cast<const float>(x_start + j * dx);
-                            }
-                        }
-                    }
+                const int block_j_end = std::min(block_j_start + block_size, width);
 
-                    // For all columns the r2 + i2 value is greater than 4.0f, then end the loop.
-                    if (count == 0) {
-                        break;
-                    }
-                }
+                calculateBlock(data + row_start + block_j_start, block_j_start, block_j_end, y);
+                checkCancelled();
             }
 
-            const int copy_row_start = (height - i - 1) * width;
+            if (mirrorHalf()) {
+                const size_t copy_row_start = static_cast<size_t>(height - i - 1) * width;
 
-            // Copy data to the other symmetrically same row.
-            #pragma omp simd simdlen(64) safelen(64)
-            for (int j = 0; j < width; j++) {
-                data[copy_row_start + j] = data[row_start + j];
+                // Copy data to the other symmetrically same row.
+                #pragma omp simd simdlen(64) safelen(64)
+                for (int j = 0; j < width; j++) {
+                    data[copy_row_start + j] = data[row_start + j];
+                }
             }
+
+            rowsComputed();
         }
+
+        // Rows above the first mirrored one are final once their block is done.
+        rowsFinished(std::min(block_i_end, last_final_row));
     }
 
+    finishRows();
+
     return data;
 }
@@ -13,13 +13,59 @@ class BatchMandelCalculator : public BaseMandelCalculator
 {
 public:
     BatchMandelCalculator(unsigned matrixBaseSize, unsigned limit);
+    /**
+     * @param tiled compute every band of rows tile by tile into a tile-major buffer, in which each
+     *              64x64 tile is contiguous, and transpose the band to row-major when it is done
+     */
+    BatchMandelCalculator(unsigned width, unsigned height, unsigned limit, bool tiled = false);
     ~BatchMandelCalculator();
     int * calculateMandelbrot();
+    void info(std::ostream & cout, bool batchMode);
+
+    /**
+     * @brief Iterates a list of arbitrary points with the block kernel, e.g. the points of several small tiles
+     *
+     * Blocks are filled across the boundaries of the tiles, so only the last one is partial.
+     *
+     * @param real real parts of the points
+     * @param imag imaginary parts of the points
+     * @param result receives the iteration counts
+     * @param count number of points
+     */
+    static void calculatePoints(const float * real, const float * imag, int * result, size_t count, int limit);
+
+    /**
+     * @brief Iterates up to one block of points, block_width of them are valid
+     */
+    typedef void (*PointKernel)(const float * real, const float * imag, int * result, int block_width, int limit);
 
 private:
-    int *data;
-    float *real_storage;
-    float *imag_storage;
+    /**
+     * @brief The kernel with the limit compiled in, the runtime one if there is none for the limit
+     */
+    static PointKernel selectKernel(int limit, bool * specialized);
+
+    /**
+     * @brief Iterates one block of a row with the selected kernel
+     */
+    void calculateBlock(int * block_data, int block_j_start, int block_j_end, float y);
+
+    /**
+     * @brief Computes rows [block_i_start, block_i_end) tile by tile into tile_band
+     */
+    void calculateTiledBand(int block_i_start, int block_i_end);
+
+    /**
+     * @brief Copies the tiles of the band to the rows of data (and their mirror images)
+     */
+    void untileBand(int block_i_start, int block_i_end);
+
+    PointKernel blockKernel; // Kernel selected for the current limit.
+    bool specializedKernel; // True if blockKernel has the limit compiled in.
+
+    const bool tiled;
+    int *tile_band; // One band of rows in tile-major order, NULL if not tiled.
+
 };
 
-#endif
\ No newline at end of file
+#endif
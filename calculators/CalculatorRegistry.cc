@@ -0,0 +1,95 @@
+/**
+ * @file CalculatorRegistry.cc
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Registry of the Mandelbrot calculators: factories, capabilities and cost hints
+ * @date 2026-10-19
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "CalculatorRegistry.h"
+
+#include "RefMandelCalculator.h"
+#include "LineMandelCalculator.h"
+#include "BatchMandelCalculator.h"
+#include "DeferredMandelCalculator.h"
+#include "InterleavedMandelCalculator.h"
+#include "FixedMandelCalculator.h"
+#include "SupersampledMandelCalculator.h"
+#include "ProgressiveMandelCalculator.h"
+
+/**
+ * @brief Widest vector extension the calculators are compiled for
+ */
+static std::string buildIsa()
+{
+#if defined(__AVX512F__)
+    return "avx512";
+#elif defined(__AVX2__)
+    return "avx2";
+#elif defined(__AVX__)
+    return "avx";
+#elif defined(__SSE2__)
+    return "sse2";
+#elif defined(__ARM_NEON)
+    return "neon";
+#else
+    return "generic";
+#endif
+}
+
+template <typename T>
+static BaseMandelCalculator *create(const CalculatorParams &params)
+{
+    return new T(params.width, params.height, params.limit);
+}
+
+static BaseMandelCalculator *createTiledBatch(const CalculatorParams &params)
+{
+    return new BatchMandelCalculator(params.width, params.height, params.limit, true);
+}
+
+static BaseMandelCalculator *createSupersampled(const CalculatorParams &params)
+{
+    return new SupersampledMandelCalculator(params.width, params.height, params.limit, std::max(params.samples, 1u), params.threshold);
+}
+
+const std::vector<CalculatorInfo> &calculatorRegistry()
+{
+    // Cost hints are the times per point relative to ref at -s 512 -i 1000 on one core.
+    static const std::vector<CalculatorInfo> registry = {
+        {"ref", "naive scalar reference", CALCULATOR_THREADS | CALCULATOR_EXACT,
+         "float32", "int32", "scalar", 1.0, create<RefMandelCalculator>},
+        {"line", "whole rows iterated with a per-point mask", CALCULATOR_THREADS | CALCULATOR_EXACT | CALCULATOR_SIMD,
+         "float32", "int32", buildIsa(), 0.6, create<LineMandelCalculator>},
+        {"batch", "64-point blocks iterated in registers, limit-specialized kernels", CALCULATOR_THREADS | CALCULATOR_EXACT | CALCULATOR_SIMD,
+         "float32", "int32", buildIsa(), 0.05, create<BatchMandelCalculator>},
+        {"batch-tiled", "batch kernel computing 64x64 tiles into a tile-major band", CALCULATOR_THREADS | CALCULATOR_EXACT | CALCULATOR_SIMD,
+         "float32", "int32", buildIsa(), 0.05, createTiledBatch},
+        {"deferred", "64-point blocks with the escape check once per 8 iterations", CALCULATOR_THREADS | CALCULATOR_EXACT | CALCULATOR_SIMD,
+         "float32", "int32", buildIsa(), 0.033, create<DeferredMandelCalculator>},
+        {"interleaved", "independent vectors iterated together to hide latency", CALCULATOR_THREADS | CALCULATOR_EXACT | CALCULATOR_SIMD,
+         "float32", "int32", buildIsa(), 0.063, create<InterleavedMandelCalculator>},
+        {"fixed", "32-bit fixed-point integer kernel", CALCULATOR_THREADS | CALCULATOR_SIMD,
+         "fixed Q3.28", "int32", buildIsa(), 0.12, create<FixedMandelCalculator>},
+        {"progressive", "coarse-to-fine passes over every 8th, 4th, 2nd and all points of the rows", CALCULATOR_THREADS | CALCULATOR_EXACT | CALCULATOR_SIMD,
+         "float32", "int32", buildIsa(), 0.6, create<ProgressiveMandelCalculator>},
+        {"supersampled", "anti-aliased smooth iteration count", CALCULATOR_THREADS | CALCULATOR_SIMD | CALCULATOR_SMOOTH,
+         "float32", "float32", buildIsa(), 0.062, createSupersampled},
+    };
+
+    return registry;
+}
+
+const CalculatorInfo *findCalculator(const std::string &name)
+{
+    for (const CalculatorInfo &info : calculatorRegistry()) {
+        if (info.name == name) {
+            return &info;
+        }
+    }
+
+    return NULL;
+}
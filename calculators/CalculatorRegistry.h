@@ -0,0 +1,63 @@
+/**
+ * @file CalculatorRegistry.h
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Registry of the Mandelbrot calculators: factories, capabilities and cost hints
+ * @date 2026-10-19
+ */
+#ifndef CALCULATORREGISTRY_H
+#define CALCULATORREGISTRY_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <BaseMandelCalculator.h>
+
+/**
+ * @brief Capability flags of a calculator
+ */
+enum CalculatorCapability
+{
+    CALCULATOR_THREADS = 1 << 0, // instances can compute row windows of one image in parallel
+    CALCULATOR_EXACT = 1 << 1,   // bit-identical to the reference calculator
+    CALCULATOR_SIMD = 1 << 2,    // vectorized kernel
+    CALCULATOR_SMOOTH = 1 << 3   // also produces float (smooth) iteration counts
+};
+
+/**
+ * @brief Everything a factory may need to construct a calculator
+ */
+struct CalculatorParams
+{
+    unsigned width;
+    unsigned height;
+    unsigned limit;
+    unsigned samples; // supersampling, samples x samples per pixel
+    float threshold; // adaptive supersampling threshold
+};
+
+struct CalculatorInfo
+{
+    std::string name; // short name used on the command line (-c)
+    std::string description;
+    unsigned capabilities; // CalculatorCapability flags
+    std::string precision; // arithmetic of the kernel
+    std::string dtype; // type of the produced values
+    std::string isa; // instruction set the kernel is built for
+    double costHint; // relative time per point, the reference calculator is 1
+    std::function<BaseMandelCalculator *(const CalculatorParams &)> create;
+};
+
+/**
+ * @brief All calculators, in the order they are listed
+ */
+const std::vector<CalculatorInfo> & calculatorRegistry();
+
+/**
+ * @brief Finds a calculator by its short name
+ *
+ * @return NULL if there is no such calculator
+ */
+const CalculatorInfo * findCalculator(const std::string & name);
+
+#endif
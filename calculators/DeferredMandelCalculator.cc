@@ -0,0 +1,158 @@
+/**
+ * @file DeferredMandelCalculator.cc
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Implementation of Mandelbrot calculator that checks the escape condition only once per chunk of iterations
+ * @date 2026-10-19
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <stdlib.h>
+#include <mm_malloc.h>
+
+#include "DeferredMandelCalculator.h"
+
+
+DeferredMandelCalculator::DeferredMandelCalculator (unsigned matrixBaseSize, unsigned limit) :
+	DeferredMandelCalculator(3 * matrixBaseSize, 2 * matrixBaseSize, limit)
+{
+}
+
+DeferredMandelCalculator::DeferredMandelCalculator (unsigned width, unsigned height, unsigned limit) :
+	BaseMandelCalculator(width, height, limit, "DeferredMandelCalculator")
+{
+}
+
+
+int * DeferredMandelCalculator::calculateMandelbrot () {
+    allocateOutput();
+
+    constexpr int block_size = 64;
+    // Number of iterations done unconditionally between two escape checks.
+    constexpr int chunk_size = 8;
+    const int rows = computedRows();
+
+    // The block state lives on the stack, so it stays in L1 (or registers).
+    alignas(64) float real[block_size];
+    alignas(64) float imag[block_size];
+    alignas(64) float z_real[block_size];
+    alignas(64) float z_imag[block_size];
+    alignas(64) float saved_real[block_size];
+    alignas(64) float saved_imag[block_size];
+    alignas(64) int escaped[block_size];
+    alignas(64) int result[block_size];
+
+    for (int i = 0; i < rows; i++) {
+        // The row index in the data array.
+        const size_t row_start = static_cast<size_t>(i) * width;
+
+        const float y = static_cast<float>(y_start + (rowOffset + i) * dy); // Current imaginary value.
+
+        for (int block_j_start = 0; block_j_start < width; block_j_start += block_size) {
+            const int block_width = std::min(block_size, width - block_j_start);
+
+            // Lanes past the end of the row start as retired: z = c = 0 never escapes.
+            #pragma omp simd simdlen(64)
+            for (int j = 0; j < block_size; j++) {
+                const bool valid = j < block_width;
+                real[j] = valid ? static_cast<float>(x_start + (block_j_start + j) * dx) : 0.0f; // Current real value.
+                imag[j] = valid ? y : 0.0f;
+                z_real[j] = real[j];
+                z_imag[j] = imag[j];
+                result[j] = limit;
+            }
+
+            int remaining = block_width;
+
+            for (int k = 0; k < limit && remaining > 0; k += chunk_size) {
+                const int steps = std::min(chunk_size, limit - k);
+
+                // Save the state at the check, so the escaped lanes can be replayed.
+                #pragma omp simd simdlen(64)
+                for (int j = 0; j < block_size; j++) {
+                    saved_real[j] = z_real[j];
+                    saved_imag[j] = z_imag[j];
+                }
+
+                // Iterate all lanes without any compare. Once |z| > 2 the lane diverges, so an
+                // escaped lane stays outside the radius (or goes to inf/NaN) until the check.
+                for (int s = 0; s < steps; s++) {
+                    #pragma omp simd simdlen(64)
+                    for (int j = 0; j < block_size; j++) {
+                        const float r2 = z_real[j] * z_real[j];
+                        const float i2 = z_imag[j] * z_imag[j];
+
+                        z_imag[j] = 2.0f * z_real[j] * z_imag[j] + imag[j];
+                        z_real[j] = r2 - i2 + real[j];
+                    }
+                }
+
+                // One check per chunk, NaN counts as escaped. A lane crossing the radius only
+                // in the last step is replayed to k + steps, the iteration it escapes at.
+                int escaped_count = 0;
+
+                #pragma omp simd reduction(+: escaped_count) simdlen(64)
+                for (int j = 0; j < block_size; j++) {
+                    escaped[j] = !(z_real[j] * z_real[j] + z_imag[j] * z_imag[j] <= 4.0f);
+                    escaped_count += escaped[j];
+                }
+
+                if (escaped_count == 0) {
+                    continue;
+                }
+
+                // Replay the escaped lanes from the saved state to find the exact iteration.
+                for (int j = 0; j < block_size; j++) {
+                    if (escaped[j]) {
+                        float zr = saved_real[j];
+                        float zi = saved_imag[j];
+                        int s = 0;
+
+                        for (; s < steps; s++) {
+                            const float r2 = zr * zr;
+                            const float i2 = zi * zi;
+
+                            if (r2 + i2 > 4.0f) {
+                                break;
+                            }
+
+                            zi = 2.0f * zr * zi + imag[j];
+                            zr = r2 - i2 + real[j];
+                        }
+
+                        result[j] = k + s;
+
+                        // Retire the lane.
+                        real[j] = imag[j] = z_real[j] = z_imag[j] = 0.0f;
+                    }
+                }
+
+                remaining -= escaped_count;
+            }
+
+            #pragma omp simd simdlen(64)
+            for (int j = 0; j < block_width; j++) {
+                data[row_start + block_j_start + j] = result[j];
+            }
+        }
+
+        if (mirrorHalf()) {
+            const size_t copy_row_start = static_cast<size_t>(height - i - 1) * width;
+
+            // Copy data to the other symmetrically same row.
+            #pragma omp simd simdlen(64) safelen(64)
+            for (int j = 0; j < width; j++) {
+                data[copy_row_start + j] = data[row_start + j];
+            }
+        }
+
+        rowsComputed();
+    }
+
+    finishRows();
+
+    return data;
+}
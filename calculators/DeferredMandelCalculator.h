@@ -0,0 +1,20 @@
+/**
+ * @file DeferredMandelCalculator.h
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Implementation of Mandelbrot calculator that checks the escape condition only once per chunk of iterations
+ * @date 2026-10-19
+ */
+#ifndef DEFERREDMANDELCALCULATOR_H
+#define DEFERREDMANDELCALCULATOR_H
+
+#include <BaseMandelCalculator.h>
+
+class DeferredMandelCalculator : public BaseMandelCalculator
+{
+public:
+    DeferredMandelCalculator(unsigned matrixBaseSize, unsigned limit);
+    DeferredMandelCalculator(unsigned width, unsigned height, unsigned limit);
+    int * calculateMandelbrot();
+};
+
+#endif
@@ -0,0 +1,141 @@
+/**
+ * @file FixedMandelCalculator.cc
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Implementation of Mandelbrot calculator that uses 32-bit fixed-point integer SIMD arithmetic
+ * @date 2026-10-19
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <stdlib.h>
+#include <mm_malloc.h>
+#include <stdexcept>
+#include <cmath>
+#include <cstdint>
+
+#include "FixedMandelCalculator.h"
+
+
+FixedMandelCalculator::FixedMandelCalculator (unsigned matrixBaseSize, unsigned limit) :
+	FixedMandelCalculator(3 * matrixBaseSize, 2 * matrixBaseSize, limit)
+{
+}
+
+FixedMandelCalculator::FixedMandelCalculator (unsigned width, unsigned height, unsigned limit) :
+	BaseMandelCalculator(width, height, limit, "FixedMandelCalculator")
+{
+    checkViewport();
+}
+
+void FixedMandelCalculator::setViewport(double xStart, double xFin, double yStart, double yFin) {
+    BaseMandelCalculator::setViewport(xStart, xFin, yStart, yFin);
+    checkViewport();
+}
+
+void FixedMandelCalculator::checkViewport() const {
+    // Points that did not escape stay within |z| <= 2, so z^2 + c has to fit into
+    // the Q3.28 range for the whole viewport.
+    if (std::max(std::fabs(x_start), std::fabs(x_fin)) > 2.0 || std::max(std::fabs(y_start), std::fabs(y_fin)) > 2.0) {
+        throw std::range_error("FixedMandelCalculator: viewport does not fit into the fixed-point range");
+    }
+}
+
+void FixedMandelCalculator::info(std::ostream &cout, bool batchMode) {
+    BaseMandelCalculator::info(cout, batchMode);
+
+    if (!batchMode) {
+        cout << "Arithmetic:        fixed-point Q3." << fraction_bits << std::endl;
+    }
+}
+
+
+int * FixedMandelCalculator::calculateMandelbrot () {
+    allocateOutput();
+
+    constexpr int block_size = 64;
+    constexpr double scale = static_cast<double>(1 << fraction_bits);
+    // Products of two Q3.28 numbers are Q6.56, the escape radius is compared in this format.
+    constexpr int64_t escape_radius = static_cast<int64_t>(4) << (2 * fraction_bits);
+    // Rounding constants for shifting the products back to Q3.28.
+    constexpr int64_t square_rounding = static_cast<int64_t>(1) << (fraction_bits - 1);
+    constexpr int64_t double_rounding = static_cast<int64_t>(1) << (fraction_bits - 2);
+    const int rows = computedRows();
+
+    alignas(64) int32_t real[block_size];
+    alignas(64) int32_t z_real[block_size];
+    alignas(64) int32_t z_imag[block_size];
+    alignas(64) int result[block_size];
+
+    for (int i = 0; i < rows; i++) {
+        // The row index in the data array.
+        const size_t row_start = static_cast<size_t>(i) * width;
+
+        const int32_t y = static_cast<int32_t>(std::lround((y_start + (rowOffset + i) * dy) * scale)); // Current imaginary value.
+
+        for (int block_j_start = 0; block_j_start < width; block_j_start += block_size) {
+            const int block_width = std::min(block_size, width - block_j_start);
+
+            // Lanes past the end of the row are marked as already escaped.
+            for (int j = 0; j < block_size; j++) {
+                real[j] = static_cast<int32_t>(std::lround((x_start + (block_j_start + j) * dx) * scale)); // Current real value.
+                z_real[j] = real[j];
+                z_imag[j] = y;
+                result[j] = (j < block_width) ? limit : 0;
+            }
+
+            // Set the count to block width. If for all columns the r2 + i2 value is greater
+            // than 4, then the value at the end of the loop (k) will be zero.
+            int count = block_width;
+
+            for (int k = 0; k < limit; k++) {
+
+                // The 32x32 -> 64-bit products map to vpmuldq.
+                #pragma omp simd reduction(-: count) simdlen(16)
+                for (int j = 0; j < block_size; j++) {
+                    if (result[j] == limit) {
+                        const int64_t r2 = static_cast<int64_t>(z_real[j]) * z_real[j];
+                        const int64_t i2 = static_cast<int64_t>(z_imag[j]) * z_imag[j];
+
+                        if (r2 + i2 > escape_radius) {
+                            result[j] = k;
+                            --count;
+                        } else {
+                            const int64_t ri = static_cast<int64_t>(z_real[j]) * z_imag[j];
+                            z_imag[j] = static_cast<int32_t>((ri + double_rounding) >> (fraction_bits - 1)) + y;
+                            z_real[j] = static_cast<int32_t>((r2 - i2 + square_rounding) >> fraction_bits) + real[j];
+                        }
+                    }
+                }
+
+                // For all columns the r2 + i2 value is greater than 4, then end the loop.
+                if (count == 0) {
+                    break;
+                }
+            }
+
+            #pragma omp simd simdlen(64)
+            for (int j = 0; j < block_width; j++) {
+                data[row_start + block_j_start + j] = result[j];
+            }
+        }
+
+        if (mirrorHalf()) {
+            const size_t copy_row_start = static_cast<size_t>(height - i - 1) * width;
+
+            // Copy data to the other symmetrically same row.
+            #pragma omp simd simdlen(64) safelen(64)
+            for (int j = 0; j < width; j++) {
+                data[copy_row_start + j] = data[row_start + j];
+            }
+        }
+
+        rowsComputed();
+    }
+
+    finishRows();
+
+    return data;
+}
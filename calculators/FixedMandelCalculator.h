@@ -0,0 +1,32 @@
+/**
+ * @file FixedMandelCalculator.h
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Implementation of Mandelbrot calculator that uses 32-bit fixed-point integer SIMD arithmetic
+ * @date 2026-10-19
+ */
+#ifndef FIXEDMANDELCALCULATOR_H
+#define FIXEDMANDELCALCULATOR_H
+
+#include <BaseMandelCalculator.h>
+
+class FixedMandelCalculator : public BaseMandelCalculator
+{
+public:
+    FixedMandelCalculator(unsigned matrixBaseSize, unsigned limit);
+    FixedMandelCalculator(unsigned width, unsigned height, unsigned limit);
+    int * calculateMandelbrot();
+    void info(std::ostream & cout, bool batchMode);
+
+    /**
+     * @brief Throws std::range_error if the viewport does not fit into the fixed-point range
+     */
+    void setViewport(double xStart, double xFin, double yStart, double yFin);
+
+    // Values are stored as Q3.28, i.e. the range is [-8, 8) with the step of 2^-28.
+    static constexpr int fraction_bits = 28;
+
+private:
+    void checkViewport() const;
+};
+
+#endif
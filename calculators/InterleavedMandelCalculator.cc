@@ -0,0 +1,125 @@
+/**
+ * @file InterleavedMandelCalculator.cc
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Implementation of Mandelbrot calculator that interleaves several independent vectors in one loop
+ * @date 2026-10-19
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <stdlib.h>
+#include <mm_malloc.h>
+
+#include "InterleavedMandelCalculator.h"
+
+
+InterleavedMandelCalculator::InterleavedMandelCalculator (unsigned matrixBaseSize, unsigned limit) :
+	InterleavedMandelCalculator(3 * matrixBaseSize, 2 * matrixBaseSize, limit)
+{
+}
+
+InterleavedMandelCalculator::InterleavedMandelCalculator (unsigned width, unsigned height, unsigned limit) :
+	BaseMandelCalculator(width, height, limit, "InterleavedMandelCalculator")
+{
+}
+
+void InterleavedMandelCalculator::info(std::ostream &cout, bool batchMode) {
+    BaseMandelCalculator::info(cout, batchMode);
+
+    if (!batchMode) {
+        cout << "Interleave factor: " << interleave_factor << " x " << vector_size << " lanes" << std::endl;
+    }
+}
+
+
+int * InterleavedMandelCalculator::calculateMandelbrot () {
+    allocateOutput();
+
+    constexpr int block_size = interleave_factor * vector_size;
+    const int rows = computedRows();
+
+    // One row of vectors per interleaved dependency chain.
+    alignas(64) float real[interleave_factor][vector_size];
+    alignas(64) float z_real[interleave_factor][vector_size];
+    alignas(64) float z_imag[interleave_factor][vector_size];
+    alignas(64) int result[interleave_factor][vector_size];
+
+    for (int i = 0; i < rows; i++) {
+        // The row index in the data array.
+        const size_t row_start = static_cast<size_t>(i) * width;
+
+        const float y = static_cast<float>(y_start + (rowOffset + i) * dy); // Current imaginary value.
+
+        for (int block_j_start = 0; block_j_start < width; block_j_start += block_size) {
+            const int block_width = std::min(block_size, width - block_j_start);
+
+            // Lanes past the end of the row are marked as already escaped.
+            for (int v = 0; v < interleave_factor; v++) {
+                #pragma omp simd simdlen(16)
+                for (int l = 0; l < vector_size; l++) {
+                    const int j = v * vector_size + l;
+                    const bool valid = j < block_width;
+                    real[v][l] = static_cast<float>(x_start + (block_j_start + j) * dx); // Current real value.
+                    z_real[v][l] = real[v][l];
+                    z_imag[v][l] = y;
+                    result[v][l] = valid ? limit : 0;
+                }
+            }
+
+            // Set the count to block width. If for all columns the r2 + i2 value is greater
+            // than 4.0f, then the value at the end of the loop (k) will be zero.
+            int count = block_width;
+
+            for (int k = 0; k < limit; k++) {
+                // The vectors do not depend on each other, so their multiplications
+                // can be in flight at the same time and hide the FMA latency.
+                for (int v = 0; v < interleave_factor; v++) {
+
+                    #pragma omp simd reduction(-: count) simdlen(16)
+                    for (int l = 0; l < vector_size; l++) {
+                        if (result[v][l] == limit) {
+                            const float r2 = z_real[v][l] * z_real[v][l];
+                            const float i2 = z_imag[v][l] * z_imag[v][l];
+
+                            if (r2 + i2 > 4.0f) {
+                                result[v][l] = k;
+                                --count;
+                            } else {
+                                z_imag[v][l] = 2.0f * z_real[v][l] * z_imag[v][l] + y;
+                                z_real[v][l] = r2 - i2 + real[v][l];
+                            }
+                        }
+                    }
+                }
+
+                // For all columns the r2 + i2 value is greater than 4.0f, then end the loop.
+                if (count == 0) {
+                    break;
+                }
+            }
+
+            for (int j = 0; j < block_width; j++) {
+                data[row_start + block_j_start + j] = result[j / vector_size][j % vector_size];
+            }
+        }
+
+        if (mirrorHalf()) {
+            const size_t copy_row_start = static_cast<size_t>(height - i - 1) * width;
+
+            // Copy data to the other symmetrically same row.
+            #pragma omp simd simdlen(64) safelen(64)
+            for (int j = 0; j < width; j++) {
+                data[copy_row_start + j] = data[row_start + j];
+            }
+        }
+
+        rowsComputed();
+    }
+
+    finishRows();
+
+    return data;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file InterleavedMandelCalculator.h
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Implementation of Mandelbrot calculator that interleaves several independent vectors in one loop
+ * @date 2026-10-19
+ */
+#ifndef INTERLEAVEDMANDELCALCULATOR_H
+#define INTERLEAVEDMANDELCALCULATOR_H
+
+#include <BaseMandelCalculator.h>
+
+// Number of independent vectors iterated together, set by the INTERLEAVE_FACTOR CMake option.
+#ifndef INTERLEAVE_FACTOR
+#define INTERLEAVE_FACTOR 4
+#endif
+
+class InterleavedMandelCalculator : public BaseMandelCalculator
+{
+public:
+    InterleavedMandelCalculator(unsigned matrixBaseSize, unsigned limit);
+    InterleavedMandelCalculator(unsigned width, unsigned height, unsigned limit);
+    int * calculateMandelbrot();
+    void info(std::ostream & cout, bool batchMode);
+
+    static constexpr int interleave_factor = INTERLEAVE_FACTOR;
+    static constexpr int vector_size = 16; // Floats in one AVX-512 register.
+
+    static_assert(interleave_factor >= 1 && interleave_factor <= 4, "INTERLEAVE_FACTOR must be between 1 and 4");
+};
+
+#endif
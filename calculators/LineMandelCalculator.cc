@@ -13,84 +13,80 @@
 
 
 #include "LineMandelCalculator.h"
+#include "MaskedRowKernel.h"
 
 
 LineMandelCalculator::LineMandelCalculator (unsigned matrixBaseSize, unsigned limit) :
-	BaseMandelCalculator(matrixBaseSize, limit, "LineMandelCalculator") {
-    data  = (int *)(_mm_malloc(height * width * sizeof(int), 64));
-    real_storage = (float *)(_mm_malloc(width * sizeof(float), 64));
-    imag_storage = (float *)(_mm_malloc(width * sizeof(float), 64));
+	LineMandelCalculator(3 * matrixBaseSize, 2 * matrixBaseSize, limit)
+{
+}
+
+LineMandelCalculator::LineMandelCalculator (unsigned width, unsigned height, unsigned limit) :
+	BaseMandelCalculator(width, height, limit, "LineMandelCalculator") {
+    c_real = allocArray<float>(width);
+    c_imag = allocArray<float>(width);
+    real_storage = allocArray<float>(width);
+    imag_storage = allocArray<float>(width);
+    row_result = allocArray<int>(width);
 }
 
 LineMandelCalculator::~LineMandelCalculator() {
-    _mm_free(data);
-    data = NULL;
+    freeBuffer(row_result);
+    row_result = NULL;
 
-    _mm_free(imag_storage);
+    freeBuffer(imag_storage);
     imag_storage = NULL;
 
-    _mm_free(real_storage);
+    freeBuffer(real_storage);
     real_storage = NULL;
+
+    freeBuffer(c_imag);
+    c_imag = NULL;
+
+    freeBuffer(c_real);
+    c_real = NULL;
 }
 
 
 int * LineMandelCalculator::calculateMandelbrot () {
-    const int half_height = height / 2;
+    allocateOutput();
 
-    // Prefill the data array with a limit value.
-    #pragma omp simd simdlen(64) safelen(64)
-    for (int i = 0; i <= half_height * width; i++) {
-        data[i] = limit;
-    }
+    const int rows = computedRows();
 
-    for (int i = 0; i <= half_height; i++) {
+    for (int i = 0; i < rows; i++) {
         // The row index in the data array.
-        const int row_start = i * width;
+        const size_t row_start = static_cast<size_t>(i) * width;
 
-        const float y = static_cast<float>(y_start + i * dy); // Current imaginary value.
+        const float y = static_cast<float>(y_start + (rowOffset + i) * dy); // Current imaginary value.
 
         #pragma omp simd simdlen(64)
         for (int j = 0; j < width; j++) {
-            real_storage[j] = static_cast<float>(x_start + j * dx); // Current real value.
-            imag_storage[j] = y;
+            c_real[j] = static_cast<float>(x_start + j * dx); // Current real value.
+            c_imag[j] = y;
         }
 
-        // Set the count to width. If for all columns the r2 + i2 value is greater than 4.0f, then
-        // the value at the end of the loop (j) will be zero.
-        int count = width;
+        iterateMaskedRow(c_real, c_imag, real_storage, imag_storage, row_result, width, width, limit);
+
+        // The row is stored once, the data array is not touched while it is iterated.
+        #pragma omp simd simdlen(64) safelen(64)
+        for (int j = 0; j < width; j++) {
+            data[row_start + j] = row_result[j];
+        }
 
-        for (int k = 0; k < limit; k++) {
+        if (mirrorHalf()) {
+            const size_t copy_row_start = static_cast<size_t>(height - i - 1) * width;
 
-            #pragma omp simd reduction(-: count) simdlen(64)
+            // Copy data to the other symmetrically same row.
+            #pragma omp simd simdlen(64) safelen(64)
             for (int j = 0; j < width; j++) {
-                if (data[row_start + j] == static_cast<int>(limit)) {
-                    const float r2 = real_storage[j] * real_storage[j];
-                    const float i2 = imag_storage[j] * imag_storage[j];
-
-                    if (r2 + i2 > 4.0f) {
-                        data[row_start + j] = k;
-                        --count;
-                    } else {
-                        imag_storage[j] = 2.0f * real_storage[j] * imag_storage[j] + y;
-                        real_storage[j] = r2 - i2 + static_cast<const float>(x_start + j * dx);
-                    }
-                }
-            }
-
-            // For all columns the r2 + i2 value is greater than 4.0f, then end the loop.
-            if (count == 0) {
-                break;
+                data[copy_row_start + j] = row_result[j];
             }
         }
 
-        const int copy_row_start = (height - i - 1) * width;
-
-        // Copy data to the other symmetrically same row.
-        #pragma omp simd simdlen(64) safelen(64)
-        for (int j = 0; j < width; j++) {
-            data[copy_row_start + j] = data[row_start + j];
-        }
+        rowsComputed();
     }
 
+    finishRows();
+
     return data;
 }
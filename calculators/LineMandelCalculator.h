@@ -11,11 +11,14 @@ class LineMandelCalculator : public BaseMandelCalculator
 {
 public:
     LineMandelCalculator(unsigned matrixBaseSize, unsigned limit);
+    LineMandelCalculator(unsigned width, unsigned height, unsigned limit);
     ~LineMandelCalculator();
     int *calculateMandelbrot();
 
 private:
-    int *data;
-    float *real_storage;
+    float *c_real; // c of the computed row
+    float *c_imag;
+    float *real_storage; // z of the computed row
     float *imag_storage;
+    int *row_result; // iteration counts of the computed row, limit while the point is iterated
 };
\ No newline at end of file
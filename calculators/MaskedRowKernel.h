@@ -0,0 +1,64 @@
+/**
+ * @file MaskedRowKernel.h
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Masked SIMD kernel over packed points, shared by the line, progressive and supersampled calculators
+ * @date 2026-10-19
+ */
+#ifndef MASKEDROWKERNEL_H
+#define MASKEDROWKERNEL_H
+
+/**
+ * @brief Iterates the packed points c_real[p] + c_imag[p] i until all of them escape or the limit is hit
+ *
+ * Every step iterates whole vectors, the escaped points are masked out. Only the first
+ * active of the n points are iterated, the rest pad the vectors and are marked as already
+ * escaped (result 0).
+ *
+ * The arrays are pointers, or references to the local arrays of a block given as the template
+ * arguments (float (&)[N], int (&)[N]). With their size the vectorizer knows the conditional
+ * accesses cannot fault and keeps the loads unmasked.
+ *
+ * @param z_real receives the last z of every point, for an escaped one the z that crossed the radius
+ * @param z_imag see z_real
+ * @param result receives the iteration counts, limit for the points in the set
+ */
+template <typename RealArray, typename IntArray>
+inline void iterateMaskedRow(RealArray c_real, RealArray c_imag, RealArray z_real, RealArray z_imag,
+                             IntArray result, int n, int active, int limit) {
+    #pragma omp simd simdlen(64)
+    for (int p = 0; p < n; p++) {
+        z_real[p] = c_real[p];
+        z_imag[p] = c_imag[p];
+        result[p] = (p < active) ? limit : 0;
+    }
+
+    // Set the count to the active points. If for all of them the r2 + i2 value is greater than 4.0f,
+    // then the value at the end of the loop will be zero.
+    int count = active;
+
+    for (int k = 0; k < limit; k++) {
+
+        #pragma omp simd reduction(-: count) simdlen(64)
+        for (int p = 0; p < n; p++) {
+            if (result[p] == limit) {
+                const float r2 = z_real[p] * z_real[p];
+                const float i2 = z_imag[p] * z_imag[p];
+
+                if (r2 + i2 > 4.0f) {
+                    result[p] = k;
+                    --count;
+                } else {
+                    z_imag[p] = 2.0f * z_real[p] * z_imag[p] + c_imag[p];
+                    z_real[p] = r2 - i2 + c_real[p];
+                }
+            }
+        }
+
+        // For all points the r2 + i2 value is greater than 4.0f, then end the loop.
+        if (count == 0) {
+            break;
+        }
+    }
+}
+
+#endif
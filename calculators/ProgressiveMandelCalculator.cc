@@ -0,0 +1,154 @@
+/**
+ * @file ProgressiveMandelCalculator.cc
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Implementation of Mandelbrot calculator refining the image in coarse-to-fine passes over lines
+ * @date 2026-10-19
+ */
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <stdlib.h>
+
+#include "ProgressiveMandelCalculator.h"
+#include "MaskedRowKernel.h"
+
+
+ProgressiveMandelCalculator::ProgressiveMandelCalculator (unsigned matrixBaseSize, unsigned limit) :
+	ProgressiveMandelCalculator(3 * matrixBaseSize, 2 * matrixBaseSize, limit)
+{
+}
+
+ProgressiveMandelCalculator::ProgressiveMandelCalculator (unsigned width, unsigned height, unsigned limit) :
+	BaseMandelCalculator(width, height, limit, "ProgressiveMandelCalculator") {
+    real_storage = allocArray<float>(width);
+    imag_storage = allocArray<float>(width);
+    c_real = allocArray<float>(width);
+    c_imag = allocArray<float>(width);
+    row_result = allocArray<int>(width);
+}
+
+ProgressiveMandelCalculator::~ProgressiveMandelCalculator() {
+    freeBuffer(row_result);
+    freeBuffer(c_imag);
+    freeBuffer(c_real);
+    freeBuffer(imag_storage);
+    freeBuffer(real_storage);
+    row_result = NULL;
+    c_real = c_imag = imag_storage = real_storage = NULL;
+}
+
+void ProgressiveMandelCalculator::info(std::ostream &cout, bool batchMode) {
+    BaseMandelCalculator::info(cout, batchMode);
+
+    if (!batchMode) {
+        cout << "Passes:            every " << firstStride << "th point first, refined to all points" << std::endl;
+    }
+}
+
+void ProgressiveMandelCalculator::setPassCallback(PassCallback callback) {
+    passCallback = callback;
+}
+
+int ProgressiveMandelCalculator::calculateRowPoints(int i, int first_column, int step) {
+    if (first_column >= width) {
+        return 0;
+    }
+
+    const int points = (width - first_column + step - 1) / step;
+    const size_t row_start = static_cast<size_t>(i) * width;
+    const float y = static_cast<float>(y_start + (rowOffset + i) * dy); // Current imaginary value.
+
+    // The points of the pass are packed, so the row kernel runs over whole vectors.
+    #pragma omp simd
+    for (int p = 0; p < points; p++) {
+        c_real[p] = static_cast<float>(x_start + (first_column + p * step) * dx);
+        c_imag[p] = y;
+    }
+
+    iterateMaskedRow(c_real, c_imag, real_storage, imag_storage, row_result, points, points, limit);
+
+    for (int p = 0; p < points; p++) {
+        data[row_start + first_column + p * step] = row_result[p];
+    }
+
+    return points;
+}
+
+void ProgressiveMandelCalculator::fillPreview(int rows, int stride) {
+    // The computed points map to themselves, so the fill can be done in place.
+    for (int i = 0; i < rows; i++) {
+        const size_t row_start = static_cast<size_t>(i) * width;
+        const size_t source_start = static_cast<size_t>(i - i % stride) * width;
+
+        for (int j = 0; j < width; j++) {
+            data[row_start + j] = data[source_start + j - j % stride];
+        }
+    }
+}
+
+int * ProgressiveMandelCalculator::calculateMandelbrot () {
+    allocateOutput();
+
+    const int rows = computedRows();
+
+    // Every point is computed once, the progress counts the points of all passes in rows.
+    size_t computed_points = 0;
+    int reported_rows = 0;
+
+    for (int stride = firstStride; stride >= 1; stride /= 2) {
+        // The previews are only built for the pass callback.
+        const bool preview = passCallback && stride > 1;
+
+        // Rows of the previous pass already have their even points of this pass.
+        for (int i = 0; i < rows; i += stride) {
+            if (stride < firstStride && i % (2 * stride) == 0) {
+                computed_points += calculateRowPoints(i, stride, 2 * stride);
+            } else {
+                computed_points += calculateRowPoints(i, 0, stride);
+            }
+
+            const int done_rows = static_cast<int>(computed_points / width);
+            if (done_rows > reported_rows) {
+                rowsComputed(done_rows - reported_rows);
+                reported_rows = done_rows;
+            } else {
+                checkCancelled();
+            }
+        }
+
+        if (preview) {
+            fillPreview(rows, stride);
+        }
+
+        if (mirrorHalf() && (preview || stride == 1)) {
+            // Rows below the computed ones are mirrored after every pass. The middle row of an
+            // even height is copied over the row above it only at the end, as by the line
+            // calculator; before that it would overwrite the computed points of that row.
+            for (int i = 0; i < rows; i++) {
+                const int mirror_row = height - i - 1;
+                if (mirror_row < rows && (stride > 1 || mirror_row > i)) {
+                    continue;
+                }
+
+                const size_t row_start = static_cast<size_t>(i) * width;
+                const size_t copy_row_start = static_cast<size_t>(mirror_row) * width;
+
+                // Copy data to the other symmetrically same row.
+                #pragma omp simd simdlen(64) safelen(64)
+                for (int j = 0; j < width; j++) {
+                    data[copy_row_start + j] = data[row_start + j];
+                }
+            }
+        }
+
+        if (passCallback) {
+            passCallback(data, stride);
+        }
+    }
+
+    finishRows();
+
+    return data;
+}
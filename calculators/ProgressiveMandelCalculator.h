@@ -0,0 +1,66 @@
+/**
+ * @file ProgressiveMandelCalculator.h
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Implementation of Mandelbrot calculator refining the image in coarse-to-fine passes over lines
+ * @date 2026-10-19
+ */
+#ifndef PROGRESSIVEMANDELCALCULATOR_H
+#define PROGRESSIVEMANDELCALCULATOR_H
+
+#include <functional>
+
+#include <BaseMandelCalculator.h>
+
+class ProgressiveMandelCalculator : public BaseMandelCalculator
+{
+public:
+    ProgressiveMandelCalculator(unsigned matrixBaseSize, unsigned limit);
+    ProgressiveMandelCalculator(unsigned width, unsigned height, unsigned limit);
+    ~ProgressiveMandelCalculator();
+
+    /**
+     * @brief Computes every 8th point of every 8th row, then the new points of the 4th, 2nd and all rows
+     *
+     * Every point is iterated once, the final result is the same as of the line calculator.
+     */
+    int * calculateMandelbrot();
+    void info(std::ostream & cout, bool batchMode);
+
+    /**
+     * @brief Called after every pass with the whole preview
+     *
+     * Points not computed yet hold the value of the computed point above and left of them,
+     * so the buffer is a blocky image of the set.
+     *
+     * @param data height * width iteration counts
+     * @param stride distance of the computed points (8, 4, 2, 1 = final)
+     */
+    typedef std::function<void(const int *data, int stride)> PassCallback;
+
+    void setPassCallback(PassCallback callback);
+
+    static constexpr int firstStride = 8; // distance of the points of the first pass
+
+private:
+    /**
+     * @brief Iterates the points first_column, first_column + step, ... of row i together
+     *
+     * @return number of the computed points
+     */
+    int calculateRowPoints(int i, int first_column, int step);
+
+    /**
+     * @brief Copies the computed points over the blocks of stride x stride points they start
+     */
+    void fillPreview(int rows, int stride);
+
+    PassCallback passCallback;
+
+    float *c_real; // c of the packed points of one pass of a row
+    float *c_imag;
+    float *real_storage; // z of the packed points
+    float *imag_storage;
+    int *row_result;
+};
+
+#endif
@@ -11,51 +11,35 @@
 
 #include "RefMandelCalculator.h"
 
-RefMandelCalculator::RefMandelCalculator(unsigned matrixBaseSize, unsigned limit) : BaseMandelCalculator(matrixBaseSize, limit, "RefMandelCalculator")
+RefMandelCalculator::RefMandelCalculator(unsigned matrixBaseSize, unsigned limit) :
+	RefMandelCalculator(3 * matrixBaseSize, 2 * matrixBaseSize, limit)
 {
-	data = (int *)(malloc(height * width * sizeof(int)));
 }
 
-RefMandelCalculator::~RefMandelCalculator()
+RefMandelCalculator::RefMandelCalculator(unsigned width, unsigned height, unsigned limit) :
+	BaseMandelCalculator(width, height, limit, "RefMandelCalculator")
 {
-	free(data);
-	data = NULL;
-}
-
-template <typename T>
-static inline int mandelbrot(T real, T imag, int limit)
-{
-	T zReal = real;
-	T zImag = imag;
-
-	for (int i = 0; i < limit; ++i)
-	{
-		T r2 = zReal * zReal;
-		T i2 = zImag * zImag;
-
-		if (r2 + i2 > 4.0f)
-			return i;
-
-		zImag = 2.0f * zReal * zImag + imag;
-		zReal = r2 - i2 + real;
-	}
-	return limit;
 }
 
 int *RefMandelCalculator::calculateMandelbrot()
 {
+	allocateOutput();
+
 	int *pdata = data;
 	for (int i = 0; i < height; i++)
 	{
 		for (int j = 0; j < width; j++)
 		{
 			float x = x_start + j * dx; // current real value
-			float y = y_start + i * dy; // current imaginary value
+			float y = y_start + (rowOffset + i) * dy; // current imaginary value
 
 			int value = mandelbrot(x, y, limit);
 
 			*(pdata++) = value;
 		}
+		rowsFinished(i + 1);
+		rowsComputed();
 	}
+	finishRows();
 	return data;
 }
\ No newline at end of file
@@ -14,10 +14,8 @@ class RefMandelCalculator : public BaseMandelCalculator
 {
 public:
     RefMandelCalculator(unsigned matrixBaseSize, unsigned limit);
-    ~RefMandelCalculator();
+    RefMandelCalculator(unsigned width, unsigned height, unsigned limit);
     int *calculateMandelbrot();
-
-private:
-    int *data;
+    int computedRows() const { return height; } // the reference does not use the symmetry
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,298 @@
+/**
+ * @file SupersampledMandelCalculator.cc
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Implementation of anti-aliased Mandelbrot calculator averaging the smooth iteration count of N x N subsamples
+ * @date 2026-10-19
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include <stdlib.h>
+
+#include "SupersampledMandelCalculator.h"
+#include "MaskedRowKernel.h"
+
+
+SupersampledMandelCalculator::SupersampledMandelCalculator (unsigned width, unsigned height, unsigned limit, unsigned samples, float threshold) :
+	BaseMandelCalculator(width, height, limit, "SupersampledMandelCalculator"), samples(samples), pixel_samples(samples * samples),
+	threshold(threshold), refined_fraction(0.0), offsets(samples), image_height(height)
+{
+    for (unsigned s = 0; s < samples; s++) {
+        offsets[s] = (2.0 * s + 1.0 - samples) / (2.0 * samples);
+    }
+
+    // Allocated by calculateMandelbrot for the rows it computes.
+    smooth = NULL;
+    smooth_rows = 0;
+
+    // Padded to whole blocks, so the last block can be loaded whole.
+    row_samples = static_cast<size_t>(width) * pixel_samples;
+    const size_t padded = (row_samples + block_size - 1) / block_size * block_size;
+    sample_real = allocArray<float>(padded);
+    sample_imag = allocArray<float>(padded);
+    sample_value = allocArray<float>(padded);
+}
+
+SupersampledMandelCalculator::~SupersampledMandelCalculator() {
+    freeBuffer(sample_value);
+    freeBuffer(sample_imag);
+    freeBuffer(sample_real);
+    freeBuffer(smooth);
+    sample_value = sample_imag = sample_real = smooth = NULL;
+}
+
+void SupersampledMandelCalculator::info(std::ostream &cout, bool batchMode) {
+    BaseMandelCalculator::info(cout, batchMode);
+
+    if (!batchMode) {
+        cout << "Supersampling:     " << samples << "x" << samples << " smooth samples per pixel";
+        if (threshold > 0.0f) {
+            cout << ", adaptive (threshold " << threshold << ")";
+        }
+        cout << std::endl;
+    }
+}
+
+void SupersampledMandelCalculator::calculateBlock(const float *block_real, const float *block_imag, float *block_value, int block_width) {
+    alignas(64) float real[block_size];
+    alignas(64) float imag[block_size];
+    alignas(64) float z_real[block_size];
+    alignas(64) float z_imag[block_size];
+    alignas(64) int result[block_size];
+
+    // Local copies, the kernel then knows the bounds of the block.
+    #pragma omp simd simdlen(64)
+    for (int j = 0; j < block_size; j++) {
+        real[j] = block_real[j];
+        imag[j] = block_imag[j];
+    }
+
+    // The subsamples of one pixel share the block, so it usually ends together.
+    iterateMaskedRow<float (&)[block_size], int (&)[block_size]>(real, imag, z_real, z_imag, result,
+                                                                 block_size, block_width, limit);
+
+    // Escaped lanes kept the z that crossed the radius: nu = k + 1 - log2(log|z|).
+    for (int j = 0; j < block_width; j++) {
+        float value = static_cast<float>(limit);
+
+        if (result[j] < limit) {
+            const float magnitude2 = z_real[j] * z_real[j] + z_imag[j] * z_imag[j];
+            value = std::max(0.0f, result[j] + 1.0f - std::log2(0.5f * std::log(magnitude2)));
+            value = std::min(value, static_cast<float>(limit));
+        }
+
+        block_value[j] = value;
+    }
+}
+
+void SupersampledMandelCalculator::calculateSamples(const float *real, const float *imag, float *value, size_t count) {
+    for (size_t start = 0; start < count; start += block_size) {
+        calculateBlock(real + start, imag + start, value + start, static_cast<int>(std::min<size_t>(block_size, count - start)));
+    }
+}
+
+void SupersampledMandelCalculator::placeSubsamples(int i, int j, size_t index) {
+    for (int sy = 0; sy < samples; sy++) {
+        for (int sx = 0; sx < samples; sx++, index++) {
+            sample_real[index] = static_cast<float>(x_start + (j + offsets[sx]) * dx);
+            sample_imag[index] = static_cast<float>(y_start + (rowOffset + i + offsets[sy]) * dy);
+        }
+    }
+}
+
+void SupersampledMandelCalculator::calculateCenterRow(int image_row, float *value) {
+    const float y = static_cast<float>(y_start + image_row * dy);
+
+    #pragma omp simd
+    for (int j = 0; j < width; j++) {
+        sample_real[j] = static_cast<float>(x_start + j * dx);
+        sample_imag[j] = y;
+    }
+
+    calculateSamples(sample_real, sample_imag, value, width);
+}
+
+void SupersampledMandelCalculator::calculateAdaptive(int rows) {
+    const float scale = 1.0f / pixel_samples;
+
+    // One sample in the center of every pixel.
+    for (int i = 0; i < rows; i++) {
+        calculateCenterRow(rowOffset + i, smooth + static_cast<size_t>(i) * width);
+        checkCancelled();
+    }
+
+    // A row window also needs the center samples of the rows around it, so a stripe refines
+    // the same pixels as the whole image. The whole image takes the rows below its middle
+    // from the mirrored upper half.
+    const bool image_symmetric = y_start == -y_fin;
+    auto image_row = [&](int row) {
+        return (image_symmetric && row >= (image_height + 1) / 2) ? image_height - row - 1 : row;
+    };
+
+    std::vector<float> row_above, row_below;
+    if (!symmetric && rowOffset > 0) {
+        row_above.resize(width);
+        calculateCenterRow(image_row(rowOffset - 1), row_above.data());
+    }
+    if (!symmetric && rowOffset + rows < image_height) {
+        row_below.resize(width);
+        calculateCenterRow(image_row(rowOffset + rows), row_below.data());
+    }
+
+    // Value of a neighbour, rows below the computed ones are mirror images of the upper ones.
+    auto neighbour = [&](int i, int j) -> float {
+        if (i < 0) {
+            return row_above[j];
+        }
+        if (i >= rows) {
+            if (!symmetric) {
+                return row_below[j];
+            }
+            i = height - i - 1;
+        }
+        return smooth[static_cast<size_t>(i) * width + j];
+    };
+
+    // The edge test reads the center samples, so all of it is done before any pixel is refined.
+    std::vector<unsigned char> refine(static_cast<size_t>(rows) * width);
+    const int first_row = row_above.empty() ? 0 : -1;
+    const int last_row = symmetric ? height : (row_below.empty() ? rows : rows + 1);
+    size_t refined = 0;
+
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < width; j++) {
+            const float value = smooth[static_cast<size_t>(i) * width + j];
+            float difference = 0.0f;
+
+            if (i > first_row)
+                difference = std::max(difference, std::abs(value - neighbour(i - 1, j)));
+            if (i + 1 < last_row)
+                difference = std::max(difference, std::abs(value - neighbour(i + 1, j)));
+            if (j > 0)
+                difference = std::max(difference, std::abs(value - neighbour(i, j - 1)));
+            if (j + 1 < width)
+                difference = std::max(difference, std::abs(value - neighbour(i, j + 1)));
+
+            refine[static_cast<size_t>(i) * width + j] = difference > threshold;
+            refined += difference > threshold;
+        }
+    }
+
+    refined_fraction = static_cast<double>(refined) / refine.size();
+
+    // The subsamples of the refined pixels from the whole image are packed into full blocks,
+    // the sample buffers hold width pixels at once.
+    std::vector<size_t> batch;
+    batch.reserve(width);
+    // Rows above the first pixel of the batch are done, refined or not.
+    int done_rows = 0;
+
+    auto flush = [&]() {
+        calculateSamples(sample_real, sample_imag, sample_value, batch.size() * pixel_samples);
+
+        for (size_t p = 0; p < batch.size(); p++) {
+            const float *pixel = sample_value + p * pixel_samples;
+            float sum = 0.0f;
+
+            #pragma omp simd reduction(+: sum)
+            for (int s = 0; s < pixel_samples; s++) {
+                sum += pixel[s];
+            }
+
+            smooth[batch[p]] = sum * scale;
+        }
+
+        const int first_pending_row = static_cast<int>((batch.back() + 1) / width);
+        rowsComputed(first_pending_row - done_rows);
+        done_rows = first_pending_row;
+
+        batch.clear();
+    };
+
+    for (size_t index = 0; index < refine.size(); index++) {
+        if (!refine[index]) {
+            continue;
+        }
+
+        placeSubsamples(static_cast<int>(index / width), static_cast<int>(index % width), batch.size() * pixel_samples);
+        batch.push_back(index);
+
+        if (batch.size() == static_cast<size_t>(width)) {
+            flush();
+        }
+    }
+
+    if (!batch.empty()) {
+        flush();
+    }
+
+    rowsComputed(rows - done_rows);
+}
+
+int * SupersampledMandelCalculator::calculateMandelbrot () {
+    allocateOutput();
+
+    if (smooth_rows < height) {
+        freeBuffer(smooth);
+        smooth = NULL;
+        smooth = allocArray<float>(static_cast<size_t>(height) * width);
+        smooth_rows = height;
+    }
+
+    const int rows = computedRows();
+    const float scale = 1.0f / pixel_samples;
+
+    if (threshold > 0.0f) {
+        calculateAdaptive(rows);
+    } else {
+        for (int i = 0; i < rows; i++) {
+            // All subsamples of a pixel go to adjacent lanes.
+            for (int j = 0; j < width; j++) {
+                placeSubsamples(i, j, static_cast<size_t>(j) * pixel_samples);
+            }
+
+            calculateSamples(sample_real, sample_imag, sample_value, row_samples);
+
+            for (int j = 0; j < width; j++) {
+                const float *pixel = sample_value + static_cast<size_t>(j) * pixel_samples;
+                float sum = 0.0f;
+
+                #pragma omp simd reduction(+: sum)
+                for (int s = 0; s < pixel_samples; s++) {
+                    sum += pixel[s];
+                }
+
+                smooth[static_cast<size_t>(i) * width + j] = sum * scale;
+            }
+
+            rowsComputed();
+        }
+
+        refined_fraction = 1.0;
+    }
+
+    #pragma omp simd simdlen(64)
+    for (size_t index = 0; index < static_cast<size_t>(rows) * width; index++) {
+        data[index] = static_cast<int>(smooth[index] + 0.5f);
+    }
+
+    // Copy data to the other symmetrically same rows that were not computed.
+    for (int i = 0; mirrorHalf() && height - i - 1 >= rows; i++) {
+        const size_t row_start = static_cast<size_t>(i) * width;
+        const size_t copy_row_start = static_cast<size_t>(height - i - 1) * width;
+
+        #pragma omp simd simdlen(64) safelen(64)
+        for (int j = 0; j < width; j++) {
+            data[copy_row_start + j] = data[row_start + j];
+            smooth[copy_row_start + j] = smooth[row_start + j];
+        }
+    }
+
+    finishRows();
+
+    return data;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file SupersampledMandelCalculator.h
+ * @author David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ * @brief Implementation of anti-aliased Mandelbrot calculator averaging the smooth iteration count of N x N subsamples
+ * @date 2026-10-19
+ */
+#ifndef SUPERSAMPLEDMANDELCALCULATOR_H
+#define SUPERSAMPLEDMANDELCALCULATOR_H
+
+#include <vector>
+
+#include <BaseMandelCalculator.h>
+
+class SupersampledMandelCalculator : public BaseMandelCalculator
+{
+public:
+    /**
+     * @param samples number of subsamples per pixel along each axis (samples x samples in total)
+     * @param threshold adaptive mode: only pixels differing from a 4-neighbour by more than this
+     *                  (in smooth iterations) are supersampled, 0 = supersample every pixel
+     */
+    SupersampledMandelCalculator(unsigned width, unsigned height, unsigned limit, unsigned samples, float threshold = 0.0f);
+    ~SupersampledMandelCalculator();
+
+    /**
+     * @brief Computes the averaged smooth iteration counts, the returned matrix holds them rounded
+     */
+    int * calculateMandelbrot();
+    void info(std::ostream & cout, bool batchMode);
+
+    /**
+     * @brief The middle row of an even height is mirrored as well, so the result matches striped rendering
+     */
+    int computedRows() const { return symmetric ? (height + 1) / 2 : height; }
+
+    /**
+     * @brief The averaged smooth iteration counts of the last calculateMandelbrot, height * width floats
+     */
+    const float * smoothResult() const { return smooth; }
+
+    /**
+     * @brief Fraction of the computed pixels that were supersampled by the last calculateMandelbrot
+     */
+    double refinedFraction() const { return refined_fraction; }
+
+private:
+    static constexpr int block_size = 64;
+
+    /**
+     * @brief Iterates one block of up to 64 samples in registers, stores their smooth iteration counts
+     */
+    void calculateBlock(const float *block_real, const float *block_imag, float *block_value, int block_width);
+
+    /**
+     * @brief Computes the smooth iteration count of count samples in blocks of 64 lanes
+     *
+     * @param real real parts, padded to whole blocks
+     * @param imag imaginary parts, padded to whole blocks
+     * @param value output smooth iteration counts
+     */
+    void calculateSamples(const float *real, const float *imag, float *value, size_t count);
+
+    /**
+     * @brief Writes the samples x samples subsample coordinates of pixel (i, j) starting at index
+     */
+    void placeSubsamples(int i, int j, size_t index);
+
+    /**
+     * @brief Computes the sample in the center of every pixel of the given row of the whole image
+     */
+    void calculateCenterRow(int image_row, float *value);
+
+    /**
+     * @brief Computes one sample per pixel, then supersamples only the pixels at the edges
+     *
+     * @param rows number of rows to compute
+     */
+    void calculateAdaptive(int rows);
+
+    const int samples; // subsamples per pixel along one axis
+    const int pixel_samples; // samples * samples
+    const float threshold; // 0 = supersample every pixel
+    double refined_fraction;
+    std::vector<double> offsets; // subsample offsets in pixels, symmetric around the pixel center
+    const int image_height; // rows of the whole image, height is the row window
+
+    float *smooth; // averaged result
+    int smooth_rows; // rows allocated in smooth
+    float *sample_real; // c of the subsamples of one row (or of one batch of refined pixels),
+                        // the subsamples of a pixel are adjacent
+    float *sample_imag;
+    float *sample_value; // smooth iteration count of every subsample of one row
+    size_t row_samples; // width * pixel_samples, capacity of the sample buffers
+};
+
+#endif
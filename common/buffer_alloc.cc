@@ -0,0 +1,172 @@
+/**
+ * @file    buffer_alloc.cc
+ *
+ * @author  David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ *
+ * @brief   Allocation of the output and scratch buffers of the calculators
+ *
+ * @date    19 October 2026
+ **/
+
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+#include <mm_malloc.h>
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "buffer_alloc.h"
+
+static thread_local HugePages hugePagesMode = HugePages::Off;
+
+// Sizes of the mapped buffers, they are not touched to keep a header in them.
+static std::mutex mappedMutex;
+static std::unordered_map<void *, size_t> mappedBuffers;
+
+HugePages threadHugePages()
+{
+	return hugePagesMode;
+}
+
+HugePagesScope::HugePagesScope(HugePages mode) : previous(hugePagesMode)
+{
+	hugePagesMode = mode;
+}
+
+HugePagesScope::~HugePagesScope()
+{
+	hugePagesMode = previous;
+}
+
+static size_t roundUp(size_t bytes, size_t alignment)
+{
+	return (bytes + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief Maps bytes aligned to a huge page, the kernel is asked to back them by transparent huge pages
+ */
+static void *mapTransparent(size_t bytes)
+{
+	// The mapping is made larger and trimmed to an aligned address.
+	const size_t mappedBytes = bytes + hugePageSize;
+	void *mapping = mmap(NULL, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mapping == MAP_FAILED)
+		return NULL;
+
+	char *start = static_cast<char *>(mapping);
+	char *aligned = reinterpret_cast<char *>(roundUp(reinterpret_cast<uintptr_t>(start), hugePageSize));
+	if (aligned > start)
+		munmap(start, aligned - start);
+	if (start + mappedBytes > aligned + bytes)
+		munmap(aligned + bytes, start + mappedBytes - (aligned + bytes));
+
+	madvise(aligned, bytes, MADV_HUGEPAGE);
+	return aligned;
+}
+
+void *allocBuffer(size_t bytes)
+{
+	if (bytes < hugePageSize)
+	{
+		void *buffer = _mm_malloc(bytes, 64);
+		if (!buffer)
+			throw std::bad_alloc();
+		return buffer;
+	}
+
+	void *buffer = NULL;
+	size_t mappedBytes;
+
+	switch (hugePagesMode)
+	{
+	case HugePages::Explicit:
+		mappedBytes = roundUp(bytes, hugePageSize);
+		buffer = mmap(NULL, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (buffer != MAP_FAILED)
+			break;
+		// The hugetlbfs pool has not enough pages.
+		/* fall through */
+	case HugePages::Transparent:
+		mappedBytes = roundUp(bytes, hugePageSize);
+		buffer = mapTransparent(mappedBytes);
+		break;
+	case HugePages::Off:
+		mappedBytes = roundUp(bytes, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+		buffer = mmap(NULL, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		break;
+	}
+
+	if (!buffer || buffer == MAP_FAILED)
+		throw std::bad_alloc();
+
+	std::lock_guard<std::mutex> lock(mappedMutex);
+	mappedBuffers[buffer] = mappedBytes;
+	return buffer;
+}
+
+void freeBuffer(void *buffer)
+{
+	if (!buffer)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mappedMutex);
+		auto mapped = mappedBuffers.find(buffer);
+		if (mapped != mappedBuffers.end())
+		{
+			munmap(buffer, mapped->second);
+			mappedBuffers.erase(mapped);
+			return;
+		}
+	}
+
+	_mm_free(buffer);
+}
+
+/**
+ * @brief Minor and major page faults of the whole process
+ */
+static uint64_t processFaults()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_minflt + usage.ru_majflt;
+}
+
+PageFaultCounter::PageFaultCounter() : fd(-1), startFaults(0)
+{
+	struct perf_event_attr attr = {};
+	attr.type = PERF_TYPE_SOFTWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+	attr.inherit = 1;
+	// Allowed to unprivileged users with the default perf_event_paranoid.
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+	if (fd < 0)
+		startFaults = processFaults();
+}
+
+PageFaultCounter::~PageFaultCounter()
+{
+	if (fd >= 0)
+		close(fd);
+}
+
+uint64_t PageFaultCounter::faults() const
+{
+	if (fd < 0)
+		return processFaults() - startFaults;
+
+	uint64_t count = 0;
+	if (read(fd, &count, sizeof(count)) != sizeof(count))
+		return 0;
+	return count;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file    buffer_alloc.h
+ *
+ * @author  David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ *
+ * @brief   Allocation of the output and scratch buffers of the calculators
+ *
+ * @date    19 October 2026
+ **/
+
+#ifndef BUFFER_ALLOC_H
+#define BUFFER_ALLOC_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Page size of the buffers of at least hugePageSize bytes
+ *
+ * Off leaves the page size to the system. Transparent asks the kernel for
+ * transparent huge pages (madvise), Explicit maps pages of the hugetlbfs pool
+ * and falls back to transparent ones if the pool is empty.
+ */
+enum class HugePages
+{
+	Off,
+	Transparent,
+	Explicit
+};
+
+constexpr size_t hugePageSize = 2 * 1024 * 1024;
+
+/**
+ * @brief Huge page mode of the buffers allocated by the calling thread, Off by default
+ */
+HugePages threadHugePages();
+
+/**
+ * @brief Sets the huge page mode of the calling thread for the lifetime of the scope
+ */
+class HugePagesScope
+{
+public:
+	explicit HugePagesScope(HugePages mode);
+	~HugePagesScope();
+
+	HugePagesScope(const HugePagesScope &) = delete;
+	HugePagesScope &operator=(const HugePagesScope &) = delete;
+
+private:
+	HugePages previous;
+};
+
+/**
+ * @brief Allocates a 64-byte aligned buffer, released by freeBuffer
+ *
+ * Buffers of at least hugePageSize bytes are mapped directly with the page size of
+ * threadHugePages() and are not touched here, so every page is placed on the NUMA
+ * node of the thread writing it first. Smaller ones come from _mm_malloc.
+ *
+ * @throw std::bad_alloc if the memory cannot be allocated
+ */
+void *allocBuffer(size_t bytes);
+void freeBuffer(void *buffer);
+
+template <typename T>
+T *allocArray(size_t count)
+{
+	return static_cast<T *>(allocBuffer(count * sizeof(T)));
+}
+
+/**
+ * @brief Counts the page faults of the calling thread and of the threads it starts
+ *
+ * Uses the PERF_COUNT_SW_PAGE_FAULTS software counter, or the faults of the whole
+ * process from getrusage if perf events are not available. Threads are counted once
+ * they have been joined.
+ */
+class PageFaultCounter
+{
+public:
+	PageFaultCounter();
+	~PageFaultCounter();
+
+	PageFaultCounter(const PageFaultCounter &) = delete;
+	PageFaultCounter &operator=(const PageFaultCounter &) = delete;
+
+	/** @brief Page faults since the construction */
+	uint64_t faults() const;
+
+private:
+	int fd;             // perf event, -1 if getrusage is used
+	uint64_t startFaults;
+};
+
+#endif // BUFFER_ALLOC_H
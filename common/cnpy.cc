@@ -13,6 +13,13 @@
 #include<stdint.h>
 #include<stdexcept>
 #include <regex>
+#include <thread>
+#include <atomic>
+#include <limits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 char cnpy::BigEndianTest() {
     int x = 1;
@@ -177,6 +184,290 @@ void cnpy::parse_zip_footer(FILE* fp, uint16_t& nrecs, size_t& global_header_siz
     assert(comment_len == 0);
 }
 
+cnpy::MappedNpyFile::MappedNpyFile(const std::string& fname, const std::vector<char>& header, size_t data_bytes)
+    : base(NULL), length(header.size() + data_bytes), data_offset(header.size())
+{
+    int fd = open(fname.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) throw std::runtime_error("npy_create_mapped: Unable to open file "+fname);
+
+    if(ftruncate(fd, length) != 0) {
+        close(fd);
+        throw std::runtime_error("npy_create_mapped: Unable to resize file "+fname);
+    }
+
+    void* addr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED) throw std::runtime_error("npy_create_mapped: Unable to map file "+fname);
+
+    base = static_cast<char*>(addr);
+    memcpy(base, &header[0], header.size());
+}
+
+cnpy::MappedNpyFile::~MappedNpyFile() {
+    munmap(base, length);
+}
+
+void cnpy::MirroredRows::read(size_t offset, size_t nbytes, char* out) const
+{
+    while(nbytes > 0) {
+        const size_t r = offset / row_bytes;
+        const size_t column = offset % row_bytes;
+        const size_t len = std::min(nbytes, row_bytes - column);
+
+        memcpy(out, row(r) + column, len);
+        out += len;
+        offset += len;
+        nbytes -= len;
+    }
+}
+
+uint32_t cnpy::crc32_mirrored(uint32_t crc, const MirroredRows& matrix, unsigned threads)
+{
+    crc = crc32_parallel(crc, matrix.data, matrix.stored_rows * matrix.row_bytes, threads);
+    for(size_t r = matrix.stored_rows; r < matrix.rows; r++)
+        crc = crc32(crc, (const Bytef*) matrix.row(r), matrix.row_bytes);
+    return crc;
+}
+
+void cnpy::npz_write_entry(std::string zipname, std::string fname, std::string mode, uint16_t compr_method, uint32_t crc, size_t uncompr_bytes,
+                           const void* prefix, size_t prefix_size, const void* payload, size_t payload_size)
+{
+    npz_write_entry(zipname, fname, mode, compr_method, crc, uncompr_bytes, prefix, prefix_size,
+                    [payload, payload_size](FILE* fp) { fwrite(payload, sizeof(char), payload_size, fp); }, payload_size);
+}
+
+void cnpy::npz_write_entry(std::string zipname, std::string fname, std::string mode, uint16_t compr_method, uint32_t crc, size_t uncompr_bytes,
+                           const void* prefix, size_t prefix_size, const std::function<void(FILE*)>& write_payload, size_t payload_size)
+{
+    //first, append a .npy to the fname
+    fname += ".npy";
+
+    size_t compr_bytes = prefix_size + payload_size;
+    if(compr_bytes > std::numeric_limits<uint32_t>::max() || uncompr_bytes > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("npz_save: entries larger than 4 GiB are not supported (no zip64)");
+
+    //now, on with the show
+    FILE* fp = NULL;
+    uint16_t nrecs = 0;
+    size_t global_header_offset = 0;
+    std::vector<char> global_header;
+
+    if(mode == "a") fp = fopen(zipname.c_str(),"r+b");
+
+    if(fp) {
+        //zip file exists. we need to add a new npy file to it.
+        //first read the footer. this gives us the offset and size of the global header
+        //then read and store the global header.
+        //below, we will write the the new data at the start of the global header then append the global header and footer below it
+        size_t global_header_size;
+        parse_zip_footer(fp,nrecs,global_header_size,global_header_offset);
+        fseek(fp,global_header_offset,SEEK_SET);
+        global_header.resize(global_header_size);
+        size_t res = fread(&global_header[0],sizeof(char),global_header_size,fp);
+        if(res != global_header_size){
+            throw std::runtime_error("npz_save: header read error while adding to existing zip");
+        }
+        fseek(fp,global_header_offset,SEEK_SET);
+    }
+    else {
+        fp = fopen(zipname.c_str(),"wb");
+    }
+
+    if(!fp) throw std::runtime_error("npz_save: Unable to open file "+zipname);
+
+    //build the local header
+    std::vector<char> local_header;
+    local_header += "PK"; //first part of sig
+    local_header += (uint16_t) 0x0403; //second part of sig
+    local_header += (uint16_t) 20; //min version to extract
+    local_header += (uint16_t) 0; //general purpose bit flag
+    local_header += (uint16_t) compr_method; //compression method
+    local_header += (uint16_t) 0; //file last mod time
+    local_header += (uint16_t) 0;     //file last mod date
+    local_header += (uint32_t) crc; //crc
+    local_header += (uint32_t) compr_bytes; //compressed size
+    local_header += (uint32_t) uncompr_bytes; //uncompressed size
+    local_header += (uint16_t) fname.size(); //fname length
+    local_header += (uint16_t) 0; //extra field length
+    local_header += fname;
+
+    //build global header
+    global_header += "PK"; //first part of sig
+    global_header += (uint16_t) 0x0201; //second part of sig
+    global_header += (uint16_t) 20; //version made by
+    global_header.insert(global_header.end(),local_header.begin()+4,local_header.begin()+30);
+    global_header += (uint16_t) 0; //file comment length
+    global_header += (uint16_t) 0; //disk number where file starts
+    global_header += (uint16_t) 0; //internal file attributes
+    global_header += (uint32_t) 0; //external file attributes
+    global_header += (uint32_t) global_header_offset; //relative offset of local file header, since it begins where the global header used to begin
+    global_header += fname;
+
+    //build footer
+    std::vector<char> footer;
+    footer += "PK"; //first part of sig
+    footer += (uint16_t) 0x0605; //second part of sig
+    footer += (uint16_t) 0; //number of this disk
+    footer += (uint16_t) 0; //disk where footer starts
+    footer += (uint16_t) (nrecs+1); //number of records on this disk
+    footer += (uint16_t) (nrecs+1); //total number of records
+    footer += (uint32_t) global_header.size(); //nbytes of global headers
+    footer += (uint32_t) (global_header_offset + compr_bytes + local_header.size()); //offset of start of global headers, since global header now starts after newly written array
+    footer += (uint16_t) 0; //zip file comment length
+
+    //write everything
+    fwrite(&local_header[0],sizeof(char),local_header.size(),fp);
+    if(prefix_size > 0) fwrite(prefix,sizeof(char),prefix_size,fp);
+    write_payload(fp);
+    fwrite(&global_header[0],sizeof(char),global_header.size(),fp);
+    fwrite(&footer[0],sizeof(char),footer.size(),fp);
+    fclose(fp);
+}
+
+uint32_t cnpy::crc32_parallel(uint32_t crc, const void* data, size_t nbytes, unsigned threads)
+{
+    //below this size the thread start-up costs more than the checksum itself
+    const size_t min_chunk_size = 1 << 20;
+
+    if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min<size_t>(threads, nbytes / min_chunk_size));
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    if(threads == 1) return crc32(crc, bytes, nbytes);
+
+    const size_t chunk_size = (nbytes + threads - 1) / threads;
+    std::vector<uint32_t> crcs(threads);
+    std::vector<std::thread> pool;
+
+    for(unsigned t = 1; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            const size_t start = std::min(t * chunk_size, nbytes);
+            crcs[t] = crc32(0L, bytes + start, std::min(chunk_size, nbytes - start));
+        });
+    }
+    crcs[0] = crc32(crc, bytes, std::min(chunk_size, nbytes));
+    for(std::thread& t : pool) t.join();
+
+    crc = crcs[0];
+    for(unsigned t = 1; t < threads; t++) {
+        const size_t start = std::min(t * chunk_size, nbytes);
+        crc = crc32_combine(crc, crcs[t], std::min(chunk_size, nbytes - start));
+    }
+    return crc;
+}
+
+//returns a pointer to len bytes of the input starting at offset, either into the input or into scratch
+typedef std::function<const unsigned char*(size_t offset, size_t len, std::vector<unsigned char>& scratch)> deflate_source;
+
+static std::vector<char> deflate_chunks(const void* prefix, size_t prefix_size, const deflate_source& source, size_t nbytes, uint32_t& crc, int level, unsigned threads)
+{
+    //chunks are big enough that the missing history at their start costs little ratio
+    const size_t chunk_size = 4 << 20;
+    const size_t window_size = 1 << MAX_WBITS;
+    const size_t nchunks = std::max<size_t>(1, (nbytes + chunk_size - 1) / chunk_size);
+
+    if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(threads, nchunks);
+
+    std::vector<std::vector<char>> streams(nchunks);
+    std::vector<uint32_t> crcs(nchunks);
+    std::atomic<size_t> next_chunk(0);
+    std::atomic<bool> failed(false);
+
+    auto worker = [&]() {
+        std::vector<unsigned char> scratch, dict_scratch;
+        size_t c;
+        while((c = next_chunk++) < nchunks && !failed) {
+            const size_t start = c * chunk_size;
+            const size_t len = std::min(chunk_size, nbytes - std::min(start, nbytes));
+            const bool first = (c == 0);
+            const bool last = (c == nchunks - 1);
+
+            const unsigned char* bytes = source(start, len, scratch);
+            crcs[c] = crc32(0L, bytes, len);
+
+            z_stream strm;
+            strm.zalloc = Z_NULL;
+            strm.zfree = Z_NULL;
+            strm.opaque = Z_NULL;
+            if(deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                failed = true;
+                return;
+            }
+
+            //prime the window with the end of the previous chunk, as pigz does
+            if(!first) {
+                const size_t dict = std::min(window_size, start);
+                deflateSetDictionary(&strm, source(start - dict, dict, dict_scratch), dict);
+            }
+
+            std::vector<char>& out = streams[c];
+            out.resize(deflateBound(&strm, len + (first ? prefix_size : 0)) + 16);
+
+            strm.next_out = reinterpret_cast<Bytef*>(&out[0]);
+            strm.avail_out = out.size();
+
+            if(first && prefix_size > 0) {
+                strm.next_in = (Bytef*) prefix;
+                strm.avail_in = prefix_size;
+                deflate(&strm, Z_NO_FLUSH);
+            }
+
+            strm.next_in = (Bytef*) bytes;
+            strm.avail_in = len;
+            int err = deflate(&strm, last ? Z_FINISH : Z_SYNC_FLUSH);
+            if((last && err != Z_STREAM_END) || (!last && (err != Z_OK || strm.avail_in != 0))) failed = true;
+
+            out.resize(out.size() - strm.avail_out);
+            deflateEnd(&strm);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for(unsigned t = 1; t < threads; t++) pool.emplace_back(worker);
+    worker();
+    for(std::thread& t : pool) t.join();
+
+    if(failed) throw std::runtime_error("deflate_parallel: compression failed");
+
+    crc = crc32(0L, (const Bytef*) prefix, prefix_size);
+    size_t total = 0;
+    for(size_t c = 0; c < nchunks; c++) {
+        const size_t start = c * chunk_size;
+        crc = crc32_combine(crc, crcs[c], std::min(chunk_size, nbytes - std::min(start, nbytes)));
+        total += streams[c].size();
+    }
+
+    std::vector<char> compressed;
+    compressed.reserve(total);
+    for(size_t c = 0; c < nchunks; c++) {
+        compressed.insert(compressed.end(), streams[c].begin(), streams[c].end());
+        std::vector<char>().swap(streams[c]);
+    }
+    return compressed;
+}
+
+std::vector<char> cnpy::deflate_parallel(const void* prefix, size_t prefix_size, const void* data, size_t nbytes, uint32_t& crc, int level, unsigned threads)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    return deflate_chunks(prefix, prefix_size, [bytes](size_t offset, size_t, std::vector<unsigned char>&) { return bytes + offset; },
+                          nbytes, crc, level, threads);
+}
+
+std::vector<char> cnpy::deflate_parallel(const void* prefix, size_t prefix_size, const MirroredRows& matrix, uint32_t& crc, int level, unsigned threads)
+{
+    //the stored part is compressed in place, only chunks reaching into the mirrored rows are gathered
+    const size_t stored_bytes = matrix.stored_rows * matrix.row_bytes;
+    auto source = [&matrix, stored_bytes](size_t offset, size_t len, std::vector<unsigned char>& scratch) -> const unsigned char* {
+        if(offset + len <= stored_bytes) return reinterpret_cast<const unsigned char*>(matrix.data) + offset;
+        scratch.resize(len);
+        matrix.read(offset, len, reinterpret_cast<char*>(scratch.data()));
+        return scratch.data();
+    };
+
+    return deflate_chunks(prefix, prefix_size, source, matrix.num_bytes(), crc, level, threads);
+}
+
 cnpy::NpyArray load_the_npy_file(FILE* fp) {
     std::vector<size_t> shape;
     size_t word_size;
@@ -190,7 +481,7 @@ cnpy::NpyArray load_the_npy_file(FILE* fp) {
     return arr;
 }
 
-cnpy::NpyArray load_the_npz_array(FILE* fp, uint32_t compr_bytes, uint32_t uncompr_bytes) {
+cnpy::NpyArray load_the_npz_array(FILE* fp, uint32_t compr_bytes, uint32_t uncompr_bytes, uint32_t crc) {
 
     std::vector<unsigned char> buffer_compr(compr_bytes);
     std::vector<unsigned char> buffer_uncompr(uncompr_bytes);
@@ -216,6 +507,9 @@ cnpy::NpyArray load_the_npz_array(FILE* fp, uint32_t compr_bytes, uint32_t uncom
     err = inflate(&d_stream, Z_FINISH);
     err = inflateEnd(&d_stream);
 
+    if(cnpy::crc32_parallel(0L,&buffer_uncompr[0],uncompr_bytes) != crc)
+        throw std::runtime_error("load_the_npz_array: CRC mismatch");
+
     std::vector<size_t> shape;
     size_t word_size;
     bool fortran_order;
@@ -229,6 +523,26 @@ cnpy::NpyArray load_the_npz_array(FILE* fp, uint32_t compr_bytes, uint32_t uncom
     return array;
 }
 
+cnpy::NpyArray load_the_stored_npz_array(FILE* fp, uint32_t uncompr_bytes, uint32_t crc) {
+    long entry_start = ftell(fp);
+    cnpy::NpyArray arr = load_the_npy_file(fp);
+
+    //the header was parsed from the stream, read it once more for the checksum
+    std::vector<unsigned char> header(uncompr_bytes - arr.num_bytes());
+    fseek(fp,entry_start,SEEK_SET);
+    size_t nread = fread(&header[0],1,header.size(),fp);
+    if(nread != header.size())
+        throw std::runtime_error("load_the_stored_npz_array: failed fread");
+    fseek(fp,arr.num_bytes(),SEEK_CUR);
+
+    uint32_t actual = crc32(0L,&header[0],header.size());
+    actual = cnpy::crc32_parallel(actual,arr.data<char>(),arr.num_bytes());
+    if(actual != crc)
+        throw std::runtime_error("load_the_stored_npz_array: CRC mismatch");
+
+    return arr;
+}
+
 cnpy::npz_t cnpy::npz_load(std::string fname) {
     FILE* fp = fopen(fname.c_str(),"rb");
 
@@ -267,11 +581,12 @@ cnpy::npz_t cnpy::npz_load(std::string fname) {
         }
 
         uint16_t compr_method = *reinterpret_cast<uint16_t*>(&local_header[0]+8);
+        uint32_t crc = *reinterpret_cast<uint32_t*>(&local_header[0]+14);
         uint32_t compr_bytes = *reinterpret_cast<uint32_t*>(&local_header[0]+18);
         uint32_t uncompr_bytes = *reinterpret_cast<uint32_t*>(&local_header[0]+22);
 
-        if(compr_method == 0) {arrays[varname] = load_the_npy_file(fp);}
-        else {arrays[varname] = load_the_npz_array(fp,compr_bytes,uncompr_bytes);}
+        if(compr_method == 0) {arrays[varname] = load_the_stored_npz_array(fp,uncompr_bytes,crc);}
+        else {arrays[varname] = load_the_npz_array(fp,compr_bytes,uncompr_bytes,crc);}
     }
 
     fclose(fp);
@@ -305,18 +620,18 @@ cnpy::NpyArray cnpy::npz_load(std::string fname, std::string varname) {
         fseek(fp,extra_field_len,SEEK_CUR); //skip past the extra field
         
         uint16_t compr_method = *reinterpret_cast<uint16_t*>(&local_header[0]+8);
+        uint32_t crc = *reinterpret_cast<uint32_t*>(&local_header[0]+14);
         uint32_t compr_bytes = *reinterpret_cast<uint32_t*>(&local_header[0]+18);
         uint32_t uncompr_bytes = *reinterpret_cast<uint32_t*>(&local_header[0]+22);
 
         if(vname == varname) {
-            NpyArray array  = (compr_method == 0) ? load_the_npy_file(fp) : load_the_npz_array(fp,compr_bytes,uncompr_bytes);
+            NpyArray array  = (compr_method == 0) ? load_the_stored_npz_array(fp,uncompr_bytes,crc) : load_the_npz_array(fp,compr_bytes,uncompr_bytes,crc);
             fclose(fp);
             return array;
         }
         else {
             //skip past the data
-            uint32_t size = *(uint32_t*) &local_header[22];
-            fseek(fp,size,SEEK_CUR);
+            fseek(fp,compr_bytes,SEEK_CUR);
         }
     }
 
@@ -338,5 +653,78 @@ cnpy::NpyArray cnpy::npy_load(std::string fname) {
     return arr;
 }
 
+//maps the whole file read-only, the mapping is released together with the last array viewing it
+static std::shared_ptr<void> map_file(const std::string& fname, size_t& length) {
+    int fd = open(fname.c_str(), O_RDONLY);
+    if(fd < 0) throw std::runtime_error("map_file: Unable to open file "+fname);
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("map_file: Unable to stat file "+fname);
+    }
+    length = st.st_size;
 
+    void* addr = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED) throw std::runtime_error("map_file: Unable to map file "+fname);
 
+    return std::shared_ptr<void>(addr, [length](void* p) { munmap(p, length); });
+}
+
+static cnpy::NpyArray view_the_npy_buffer(char* buffer, size_t length, std::shared_ptr<void> owner) {
+    if(length < 10) throw std::runtime_error("view_the_npy_buffer: truncated header");
+
+    std::vector<size_t> shape;
+    size_t word_size;
+    bool fortran_order;
+    cnpy::parse_npy_header(reinterpret_cast<unsigned char*>(buffer),word_size,shape,fortran_order);
+
+    size_t header_size = 10 + *reinterpret_cast<uint16_t*>(buffer+8);
+    cnpy::NpyArray arr(shape, word_size, fortran_order, buffer + header_size, owner);
+    if(header_size + arr.num_bytes() > length)
+        throw std::runtime_error("view_the_npy_buffer: truncated data");
+    return arr;
+}
+
+cnpy::NpyArray cnpy::npy_load_mapped(std::string fname) {
+    size_t length;
+    std::shared_ptr<void> mapping = map_file(fname, length);
+    return view_the_npy_buffer(static_cast<char*>(mapping.get()), length, mapping);
+}
+
+cnpy::NpyArray cnpy::npz_load_mapped(std::string fname, std::string varname) {
+    size_t length;
+    std::shared_ptr<void> mapping = map_file(fname, length);
+    char* base = static_cast<char*>(mapping.get());
+
+    size_t offset = 0;
+    while(offset + 30 <= length) {
+        char* local_header = base + offset;
+
+        //if we've reached the global header, stop reading
+        if(local_header[2] != 0x03 || local_header[3] != 0x04) break;
+
+        uint16_t compr_method = *reinterpret_cast<uint16_t*>(local_header+8);
+        uint32_t compr_bytes = *reinterpret_cast<uint32_t*>(local_header+18);
+        uint16_t name_len = *reinterpret_cast<uint16_t*>(local_header+26);
+        uint16_t extra_field_len = *reinterpret_cast<uint16_t*>(local_header+28);
+
+        std::string vname(local_header+30, name_len);
+        vname.erase(vname.end()-4,vname.end()); //erase the lagging .npy
+
+        size_t data_offset = offset + 30 + name_len + extra_field_len;
+        if(data_offset + compr_bytes > length)
+            throw std::runtime_error("npz_load_mapped: truncated file "+fname);
+
+        if(vname == varname) {
+            if(compr_method != 0)
+                throw std::runtime_error("npz_load_mapped: "+varname+" is compressed, use npz_load");
+            return view_the_npy_buffer(base + data_offset, compr_bytes, mapping);
+        }
+
+        offset = data_offset + compr_bytes;
+    }
+
+    throw std::runtime_error("npz_load_mapped: Variable name "+varname+" not found in "+fname);
+}
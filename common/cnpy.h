@@ -20,6 +20,7 @@
 #include<memory>
 #include<stdint.h>
 #include<numeric>
+#include<functional>
 
 namespace cnpy {
 
@@ -31,18 +32,27 @@ namespace cnpy {
             for(size_t i = 0;i < shape.size();i++) num_vals *= shape[i];
             data_holder = std::shared_ptr<std::vector<char>>(
                 new std::vector<char>(num_vals * word_size));
+            raw_data = data_holder->data();
         }
 
-        NpyArray() : shape(0), word_size(0), fortran_order(0), num_vals(0) { }
+        //view of an array stored elsewhere (e.g. in a mapped file), owner keeps the memory alive
+        NpyArray(const std::vector<size_t>& _shape, size_t _word_size, bool _fortran_order, char* _data, std::shared_ptr<void> _owner) :
+            view_owner(_owner), shape(_shape), word_size(_word_size), fortran_order(_fortran_order), raw_data(_data)
+        {
+            num_vals = 1;
+            for(size_t i = 0;i < shape.size();i++) num_vals *= shape[i];
+        }
+
+        NpyArray() : shape(0), word_size(0), fortran_order(0), num_vals(0), raw_data(NULL) { }
 
         template<typename T>
         T* data() {
-            return reinterpret_cast<T*>(&(*data_holder)[0]);
+            return reinterpret_cast<T*>(raw_data);
         }
 
         template<typename T>
         const T* data() const {
-            return reinterpret_cast<T*>(&(*data_holder)[0]);
+            return reinterpret_cast<T*>(raw_data);
         }
 
         template<typename T>
@@ -52,18 +62,63 @@ namespace cnpy {
         }
 
         size_t num_bytes() const {
-            return data_holder->size();
+            return num_vals * word_size;
         }
 
         std::shared_ptr<std::vector<char>> data_holder;
+        std::shared_ptr<void> view_owner;
         std::vector<size_t> shape;
         size_t word_size;
         bool fortran_order;
         size_t num_vals;
+
+    private:
+        char* raw_data;
     };
    
     using npz_t = std::map<std::string, NpyArray>; 
 
+    //npy file created at its final size and mapped into memory, so the array can be computed in place.
+    //the mapping is written back to the file when the object is destroyed
+    class MappedNpyFile {
+    public:
+        MappedNpyFile(const std::string& fname, const std::vector<char>& header, size_t data_bytes);
+        ~MappedNpyFile();
+
+        MappedNpyFile(const MappedNpyFile&) = delete;
+        MappedNpyFile& operator=(const MappedNpyFile&) = delete;
+
+        template<typename T>
+        T* data() {
+            return reinterpret_cast<T*>(base + data_offset);
+        }
+
+    private:
+        char* base;
+        size_t length;
+        size_t data_offset;
+    };
+
+    //matrix stored as its first stored_rows rows, row r >= stored_rows is the stored row rows - r - 1
+    //(the matrix is symmetric around its middle row). stored_rows = rows for a matrix stored whole
+    struct MirroredRows {
+        const char* data;
+        size_t row_bytes;
+        size_t rows;
+        size_t stored_rows;
+
+        const char* row(size_t r) const {
+            return data + (r < stored_rows ? r : rows - r - 1) * row_bytes;
+        }
+
+        size_t num_bytes() const {
+            return rows * row_bytes;
+        }
+
+        //copies nbytes of the whole matrix starting at offset to out
+        void read(size_t offset, size_t nbytes, char* out) const;
+    };
+
     char BigEndianTest();
     char map_type(const std::type_info& t);
     template<typename T> std::vector<char> create_npy_header(const std::vector<size_t>& shape);
@@ -74,6 +129,35 @@ namespace cnpy {
     NpyArray npz_load(std::string fname, std::string varname);
     NpyArray npy_load(std::string fname);
 
+    //map the file read-only and return a view into it instead of reading a copy. npz entries have to be
+    //stored (not deflated). the data is neither read nor CRC-checked until it is accessed
+    NpyArray npy_load_mapped(std::string fname);
+    NpyArray npz_load_mapped(std::string fname, std::string varname);
+
+    //CRC-32 of data continuing from crc, computed in chunks on several threads (0 = all hardware threads)
+    //and merged with crc32_combine
+    uint32_t crc32_parallel(uint32_t crc, const void* data, size_t nbytes, unsigned threads = 0);
+
+    //CRC-32 of the whole matrix, the stored rows are checksummed in parallel
+    uint32_t crc32_mirrored(uint32_t crc, const MirroredRows& matrix, unsigned threads = 0);
+
+    //writes one entry (already checksummed, possibly compressed) into the zip file. the entry content is
+    //prefix followed by payload, compr_method is 0 (stored) or 8 (deflated)
+    void npz_write_entry(std::string zipname, std::string fname, std::string mode, uint16_t compr_method, uint32_t crc, size_t uncompr_bytes,
+                         const void* prefix, size_t prefix_size, const void* payload, size_t payload_size);
+
+    //same as above, the payload of payload_size bytes is written by write_payload
+    void npz_write_entry(std::string zipname, std::string fname, std::string mode, uint16_t compr_method, uint32_t crc, size_t uncompr_bytes,
+                         const void* prefix, size_t prefix_size, const std::function<void(FILE*)>& write_payload, size_t payload_size);
+
+    //raw-deflates prefix followed by data using several threads (0 = all hardware threads). every chunk ends
+    //on a byte boundary (Z_SYNC_FLUSH), so the concatenated chunks form one valid deflate stream. crc is the
+    //CRC-32 of the uncompressed input
+    std::vector<char> deflate_parallel(const void* prefix, size_t prefix_size, const void* data, size_t nbytes, uint32_t& crc, int level = Z_DEFAULT_COMPRESSION, unsigned threads = 0);
+
+    //same as above for the whole mirrored matrix, the missing rows are gathered chunk by chunk
+    std::vector<char> deflate_parallel(const void* prefix, size_t prefix_size, const MirroredRows& matrix, uint32_t& crc, int level = Z_DEFAULT_COMPRESSION, unsigned threads = 0);
+
     template<typename T> std::vector<char>& operator+=(std::vector<char>& lhs, const T rhs) {
         //write in little endian
         for(size_t byte = 0; byte < sizeof(T); byte++) {
@@ -134,92 +218,67 @@ namespace cnpy {
 
     template<typename T> void npz_save(std::string zipname, std::string fname, const T* data, const std::vector<size_t>& shape, std::string mode = "w")
     {
-        //first, append a .npy to the fname
-        fname += ".npy";
+        std::vector<char> npy_header = create_npy_header<T>(shape);
 
-        //now, on with the show
-        FILE* fp = NULL;
-        uint16_t nrecs = 0;
-        size_t global_header_offset = 0;
-        std::vector<char> global_header;
+        size_t nels = std::accumulate(shape.begin(),shape.end(),1,std::multiplies<size_t>());
+        size_t nbytes = nels*sizeof(T) + npy_header.size();
 
-        if(mode == "a") fp = fopen(zipname.c_str(),"r+b");
+        //get the CRC of the data to be added
+        uint32_t crc = crc32(0L,(uint8_t*)&npy_header[0],npy_header.size());
+        crc = crc32_parallel(crc,data,nels*sizeof(T));
 
-        if(fp) {
-            //zip file exists. we need to add a new npy file to it.
-            //first read the footer. this gives us the offset and size of the global header
-            //then read and store the global header.
-            //below, we will write the the new data at the start of the global header then append the global header and footer below it
-            size_t global_header_size;
-            parse_zip_footer(fp,nrecs,global_header_size,global_header_offset);
-            fseek(fp,global_header_offset,SEEK_SET);
-            global_header.resize(global_header_size);
-            size_t res = fread(&global_header[0],sizeof(char),global_header_size,fp);
-            if(res != global_header_size){
-                throw std::runtime_error("npz_save: header read error while adding to existing zip");
-            }
-            fseek(fp,global_header_offset,SEEK_SET);
-        }
-        else {
-            fp = fopen(zipname.c_str(),"wb");
-        }
+        npz_write_entry(zipname,fname,mode,0,crc,nbytes,&npy_header[0],npy_header.size(),data,nels*sizeof(T));
+    }
 
+    //same as npz_save, but the entry is deflated (np.savez_compressed). the data is split into chunks
+    //which are compressed by several threads and concatenated into a single deflate stream
+    template<typename T> void npz_save_compressed(std::string zipname, std::string fname, const T* data, const std::vector<size_t>& shape, std::string mode = "w", unsigned threads = 0)
+    {
         std::vector<char> npy_header = create_npy_header<T>(shape);
 
         size_t nels = std::accumulate(shape.begin(),shape.end(),1,std::multiplies<size_t>());
         size_t nbytes = nels*sizeof(T) + npy_header.size();
 
-        //get the CRC of the data to be added
+        uint32_t crc;
+        std::vector<char> compressed = deflate_parallel(&npy_header[0],npy_header.size(),data,nels*sizeof(T),crc,Z_DEFAULT_COMPRESSION,threads);
+
+        npz_write_entry(zipname,fname,mode,8,crc,nbytes,NULL,0,&compressed[0],compressed.size());
+    }
+
+    //npz_save of a 2D matrix symmetric around its middle row, of which only the first stored_rows rows are
+    //in data (see MirroredRows). the other rows are written from the stored ones
+    template<typename T> void npz_save_mirrored(std::string zipname, std::string fname, const T* data, const std::vector<size_t>& shape, size_t stored_rows, std::string mode = "w")
+    {
+        std::vector<char> npy_header = create_npy_header<T>(shape);
+        const MirroredRows matrix = {reinterpret_cast<const char*>(data), shape[1]*sizeof(T), shape[0], stored_rows};
+
         uint32_t crc = crc32(0L,(uint8_t*)&npy_header[0],npy_header.size());
-        crc = crc32(crc,(uint8_t*)data,nels*sizeof(T));
-
-        //build the local header
-        std::vector<char> local_header;
-        local_header += "PK"; //first part of sig
-        local_header += (uint16_t) 0x0403; //second part of sig
-        local_header += (uint16_t) 20; //min version to extract
-        local_header += (uint16_t) 0; //general purpose bit flag
-        local_header += (uint16_t) 0; //compression method
-        local_header += (uint16_t) 0; //file last mod time
-        local_header += (uint16_t) 0;     //file last mod date
-        local_header += (uint32_t) crc; //crc
-        local_header += (uint32_t) nbytes; //compressed size
-        local_header += (uint32_t) nbytes; //uncompressed size
-        local_header += (uint16_t) fname.size(); //fname length
-        local_header += (uint16_t) 0; //extra field length
-        local_header += fname;
-
-        //build global header
-        global_header += "PK"; //first part of sig
-        global_header += (uint16_t) 0x0201; //second part of sig
-        global_header += (uint16_t) 20; //version made by
-        global_header.insert(global_header.end(),local_header.begin()+4,local_header.begin()+30);
-        global_header += (uint16_t) 0; //file comment length
-        global_header += (uint16_t) 0; //disk number where file starts
-        global_header += (uint16_t) 0; //internal file attributes
-        global_header += (uint32_t) 0; //external file attributes
-        global_header += (uint32_t) global_header_offset; //relative offset of local file header, since it begins where the global header used to begin
-        global_header += fname;
-
-        //build footer
-        std::vector<char> footer;
-        footer += "PK"; //first part of sig
-        footer += (uint16_t) 0x0605; //second part of sig
-        footer += (uint16_t) 0; //number of this disk
-        footer += (uint16_t) 0; //disk where footer starts
-        footer += (uint16_t) (nrecs+1); //number of records on this disk
-        footer += (uint16_t) (nrecs+1); //total number of records
-        footer += (uint32_t) global_header.size(); //nbytes of global headers
-        footer += (uint32_t) (global_header_offset + nbytes + local_header.size()); //offset of start of global headers, since global header now starts after newly written array
-        footer += (uint16_t) 0; //zip file comment length
-
-        //write everything
-        fwrite(&local_header[0],sizeof(char),local_header.size(),fp);
-        fwrite(&npy_header[0],sizeof(char),npy_header.size(),fp);
-        fwrite(data,sizeof(T),nels,fp);
-        fwrite(&global_header[0],sizeof(char),global_header.size(),fp);
-        fwrite(&footer[0],sizeof(char),footer.size(),fp);
-        fclose(fp);
+        crc = crc32_mirrored(crc,matrix);
+
+        npz_write_entry(zipname,fname,mode,0,crc,matrix.num_bytes() + npy_header.size(),&npy_header[0],npy_header.size(),
+                        [&matrix](FILE* fp) {
+                            fwrite(matrix.data,1,matrix.stored_rows*matrix.row_bytes,fp);
+                            for(size_t r = matrix.stored_rows; r < matrix.rows; r++) fwrite(matrix.row(r),1,matrix.row_bytes,fp);
+                        },
+                        matrix.num_bytes());
+    }
+
+    //npz_save_compressed of a matrix stored as in npz_save_mirrored
+    template<typename T> void npz_save_compressed_mirrored(std::string zipname, std::string fname, const T* data, const std::vector<size_t>& shape, size_t stored_rows, std::string mode = "w", unsigned threads = 0)
+    {
+        std::vector<char> npy_header = create_npy_header<T>(shape);
+        const MirroredRows matrix = {reinterpret_cast<const char*>(data), shape[1]*sizeof(T), shape[0], stored_rows};
+
+        uint32_t crc;
+        std::vector<char> compressed = deflate_parallel(&npy_header[0],npy_header.size(),matrix,crc,Z_DEFAULT_COMPRESSION,threads);
+
+        npz_write_entry(zipname,fname,mode,8,crc,matrix.num_bytes() + npy_header.size(),NULL,0,&compressed[0],compressed.size());
+    }
+
+    template<typename T> std::unique_ptr<MappedNpyFile> npy_create_mapped(std::string fname, const std::vector<size_t>& shape) {
+        std::vector<char> header = create_npy_header<T>(shape);
+        size_t nels = std::accumulate(shape.begin(),shape.end(),1,std::multiplies<size_t>());
+        return std::unique_ptr<MappedNpyFile>(new MappedNpyFile(fname,header,nels*sizeof(T)));
     }
 
     template<typename T> void npy_save(std::string fname, const std::vector<T> data, std::string mode = "w") {
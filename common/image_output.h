@@ -0,0 +1,90 @@
+/**
+ * @file    image_output.h
+ *
+ * @author  David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ *
+ * @brief   Colormapped PNG/PPM output of the iteration matrix
+ *
+ * @date    19 October 2026
+ **/
+
+#ifndef IMAGE_OUTPUT_H
+#define IMAGE_OUTPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Builds the colormap lookup table for iteration counts 0..limit
+ *
+ * Colors of scripts/visualise.py without its hill shading: matplotlib's "hot"
+ * colormap over a 0.2 power norm, points in the set are white. Entries are
+ * packed as 0x00BBGGRR.
+ *
+ * @param steps entries per one iteration, more than one for fractional (smooth) counts
+ */
+std::vector<uint32_t> createColormap(int limit, int steps = 1);
+
+/**
+ * @brief Colormap entries per iteration used for the smooth (float) iteration counts
+ */
+constexpr int smoothColormapSteps = 16;
+
+/**
+ * @brief Converts one row of iteration counts to packed RGB bytes
+ *
+ * @param row iteration counts
+ * @param width number of points in the row
+ * @param colormap table from createColormap
+ * @param limit the iteration limit the table was created for
+ * @param rgb output, 3 * width bytes
+ */
+void colorizeRow(const int *row, size_t width, const std::vector<uint32_t> &colormap, int limit, unsigned char *rgb);
+void colorizeRow(const float *row, size_t width, const std::vector<uint32_t> &colormap, int limit, unsigned char *rgb);
+
+/**
+ * @brief Writes a colormapped PNG of a (possibly strided) part of the matrix
+ *
+ * @param data first point of the region
+ * @param height number of rows
+ * @param width number of points in a row
+ * @param stride distance between rows in points
+ * @param colormap table from createColormap
+ * @param limit the iteration limit
+ * @param threads number of threads, 0 = all hardware threads
+ */
+void savePng(const std::string &fileName, const int *data, size_t height, size_t width, size_t stride,
+             const std::vector<uint32_t> &colormap, int limit, unsigned threads = 0);
+void savePng(const std::string &fileName, const float *data, size_t height, size_t width, size_t stride,
+             const std::vector<uint32_t> &colormap, int limit, unsigned threads = 0);
+
+/**
+ * @brief Tells if the file name has an image extension (.png or .ppm)
+ */
+bool isImageFile(const std::string &fileName);
+
+/**
+ * @brief Writes the matrix as a colormapped image, the format is given by the extension
+ *
+ * PNG rows are colormapped and deflated in parallel bands which are joined into one zlib stream.
+ *
+ * @param fileName .png or .ppm file
+ * @param data height * width iteration counts
+ * @param limit the iteration limit
+ * @param threads number of threads, 0 = all hardware threads
+ */
+void saveImage(const std::string &fileName, const int *data, size_t height, size_t width, int limit, unsigned threads = 0);
+void saveImage(const std::string &fileName, const float *data, size_t height, size_t width, int limit, unsigned threads = 0);
+
+/**
+ * @brief saveImage of a matrix symmetric around its middle row stored as its upper part
+ *
+ * Row r >= storedRows of the image is written from the stored row height - r - 1.
+ *
+ * @param data storedRows * width iteration counts
+ */
+void saveMirroredImage(const std::string &fileName, const int *data, size_t height, size_t storedRows, size_t width, int limit, unsigned threads = 0);
+
+#endif // IMAGE_OUTPUT_H
@@ -0,0 +1,119 @@
+/**
+ * @file    result_compare.cc
+ *
+ * @author  David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ *
+ * @brief   Comparison of two Mandelbrot iteration matrices, native counterpart of scripts/compare.py
+ *
+ * @date    19 October 2026
+ **/
+
+#include <algorithm>
+#include <climits>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+#include "result_compare.h"
+
+/**
+ * @brief Runs fn(start, end, t) on equal chunks of [0, size) in parallel
+ */
+template <typename F>
+static void parallelChunks(size_t size, unsigned threads, F fn)
+{
+	const size_t chunk = (size + threads - 1) / threads;
+	std::vector<std::thread> pool;
+
+	for (unsigned t = 1; t < threads; t++)
+		pool.emplace_back([=]() { fn(std::min(t * chunk, size), std::min((t + 1) * chunk, size), t); });
+
+	fn(0, std::min(chunk, size), 0);
+
+	for (std::thread &t : pool)
+		t.join();
+}
+
+bool compareResults(const int *a, const int *b, size_t height, size_t width, size_t maxReported, std::ostream &out, unsigned threads)
+{
+	const char *fail = "[\033[91mfail\033[0m]";
+	const char *ok = "[\033[92mok\033[0m]";
+
+	const size_t size = height * width;
+
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = std::max<size_t>(1, std::min<size_t>(threads, size / 65536));
+
+	// The points in the set have the maximal value of the matrix.
+	std::vector<int> maxA(threads, INT_MIN), maxB(threads, INT_MIN);
+
+	parallelChunks(size, threads, [&](size_t start, size_t end, unsigned t) {
+		int ma = INT_MIN, mb = INT_MIN;
+
+		#pragma omp simd reduction(max: ma, mb)
+		for (size_t i = start; i < end; i++)
+		{
+			ma = std::max(ma, a[i]);
+			mb = std::max(mb, b[i]);
+		}
+
+		maxA[t] = ma;
+		maxB[t] = mb;
+	});
+
+	const int limitA = *std::max_element(maxA.begin(), maxA.end());
+	const int limitB = *std::max_element(maxB.begin(), maxB.end());
+
+	std::vector<size_t> farCounts(threads), invalidCounts(threads);
+
+	parallelChunks(size, threads, [&](size_t start, size_t end, unsigned t) {
+		size_t far = 0, invalid = 0;
+
+		#pragma omp simd reduction(+: far, invalid)
+		for (size_t i = start; i < end; i++)
+		{
+			const int diff = a[i] - b[i];
+			far += (diff > 1 || diff < -1);
+			invalid += ((a[i] == limitA) != (b[i] == limitB));
+		}
+
+		farCounts[t] = far;
+		invalidCounts[t] = invalid;
+	});
+
+	size_t far = 0, invalid = 0;
+	for (unsigned t = 0; t < threads; t++)
+	{
+		far += farCounts[t];
+		invalid += invalidCounts[t];
+	}
+
+	const double close = static_cast<double>(invalid) / size;
+
+	if (far == 0)
+	{
+		out << ok << " Results are same" << std::endl;
+		return true;
+	}
+
+	if (close < 0.001)
+	{
+		out << ok << " Results are very close (eps = " << std::fixed << std::setprecision(3) << close * 100.0 << "% )" << std::endl;
+		return true;
+	}
+
+	out << fail << " Results differs in " << far << " values" << std::endl;
+
+	size_t reported = 0;
+	for (size_t i = 0; i < size && reported < maxReported; i++)
+	{
+		if (a[i] != b[i])
+		{
+			out << "  - (" << i / width << ", " << i % width << ") " << a[i] << " " << b[i] << std::endl;
+			reported++;
+		}
+	}
+
+	return false;
+}
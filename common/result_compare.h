@@ -0,0 +1,34 @@
+/**
+ * @file    result_compare.h
+ *
+ * @author  David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ *
+ * @brief   Comparison of two Mandelbrot iteration matrices, native counterpart of scripts/compare.py
+ *
+ * @date    19 October 2026
+ **/
+
+#ifndef RESULT_COMPARE_H
+#define RESULT_COMPARE_H
+
+#include <cstddef>
+#include <ostream>
+
+/**
+ * @brief Compares two matrices with the rules of scripts/compare.py
+ *
+ * Results are accepted if no value differs by more than 1, or if less than 0.1 %
+ * of the points differ in membership (value equal to the matrix maximum).
+ *
+ * @param a first matrix (reference)
+ * @param b second matrix
+ * @param height number of rows
+ * @param width number of columns
+ * @param maxReported number of differing points printed on failure
+ * @param out stream for the verdict
+ * @param threads number of threads, 0 = all hardware threads
+ * @return true if the results are same or very close
+ */
+bool compareResults(const int *a, const int *b, size_t height, size_t width, size_t maxReported, std::ostream &out, unsigned threads = 0);
+
+#endif // RESULT_COMPARE_H
@@ -0,0 +1,251 @@
+/**
+ * @file    tile_pyramid.cc
+ *
+ * @author  David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ *
+ * @brief   Streaming writer of a tiled multi-resolution image pyramid
+ *
+ * @date    19 October 2026
+ **/
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/stat.h>
+
+#include "image_output.h"
+#include "tile_pyramid.h"
+
+/**
+ * @brief Creates a directory, an existing one is fine
+ */
+static void createDirectory(const std::string &path)
+{
+	if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST)
+		throw std::runtime_error("TilePyramid: Unable to create directory " + path + ": " + std::strerror(errno));
+}
+
+TilePyramid::TilePyramid(const std::string &directory, size_t height, size_t width, int limit, size_t tileSize, unsigned threads)
+	: directory(directory), limit(limit), tileSize(tileSize),
+	  threads(threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads),
+	  colormap(createColormap(limit)), tiles(0)
+{
+	// Halve the resolution until the whole image fits one tile.
+	std::vector<Level> levels;
+	size_t h = height;
+	size_t w = width;
+	while (true)
+	{
+		Level level = {};
+		level.height = h;
+		level.width = w;
+		levels.push_back(level);
+
+		if (std::max(h, w) <= tileSize)
+			break;
+		h = (h + 1) / 2;
+		w = (w + 1) / 2;
+	}
+	pyramid.assign(levels.rbegin(), levels.rend());
+
+	createDirectory(directory);
+	for (size_t l = 0; l < pyramid.size(); l++)
+	{
+		Level &level = pyramid[l];
+		level.band.resize(tileSize * level.width);
+		if (l > 0)
+			level.pending.resize(level.width);
+		createDirectory(directory + "/" + std::to_string(l));
+	}
+}
+
+void TilePyramid::addRows(const int *rows, size_t count)
+{
+	const size_t finest = pyramid.size() - 1;
+	const size_t width = pyramid[finest].width;
+
+	for (size_t r = 0; r < count; r++)
+		pushRow(finest, rows + r * width);
+}
+
+void TilePyramid::finish() const
+{
+	for (const Level &level : pyramid)
+	{
+		if (level.received != level.height)
+			throw std::runtime_error("TilePyramid: image is incomplete");
+	}
+}
+
+void TilePyramid::pushRow(size_t l, const int *row)
+{
+	Level &level = pyramid[l];
+	if (level.received == level.height)
+		throw std::runtime_error("TilePyramid: too many rows");
+
+	std::copy(row, row + level.width, level.band.begin() + level.bandRows * level.width);
+	level.bandRows++;
+	level.received++;
+
+	if (l > 0)
+	{
+		if (!level.hasPending)
+		{
+			std::copy(row, row + level.width, level.pending.begin());
+			level.hasPending = true;
+		}
+
+		// A pair of rows (or the odd last row alone) makes one row of the coarser level.
+		if (level.received % 2 == 0 || level.received == level.height)
+		{
+			const int *upper = level.pending.data();
+			const int *lower = row;
+			const size_t coarseWidth = pyramid[l - 1].width;
+
+			std::vector<int> coarseRow(coarseWidth);
+			#pragma omp simd
+			for (size_t j = 0; j < level.width / 2; j++)
+			{
+				coarseRow[j] = (upper[2 * j] + upper[2 * j + 1] + lower[2 * j] + lower[2 * j + 1] + 2) / 4;
+			}
+			if (level.width % 2 != 0)
+			{
+				coarseRow[coarseWidth - 1] = (upper[level.width - 1] + lower[level.width - 1] + 1) / 2;
+			}
+
+			level.hasPending = false;
+			pushRow(l - 1, coarseRow.data());
+		}
+	}
+
+	if (level.bandRows == tileSize || level.received == level.height)
+		writeBand(l);
+}
+
+void TilePyramid::writeBand(size_t l)
+{
+	Level &level = pyramid[l];
+	const size_t tileRow = level.bandStart / tileSize;
+	const size_t columns = (level.width + tileSize - 1) / tileSize;
+	const unsigned workers = std::max<size_t>(1, std::min<size_t>(threads, columns));
+
+	std::atomic<size_t> nextColumn(0);
+	auto worker = [&]() {
+		size_t c;
+		while ((c = nextColumn++) < columns)
+		{
+			const size_t firstColumn = c * tileSize;
+			const std::string fileName = directory + "/" + std::to_string(l) + "/" +
+			                             std::to_string(c) + "_" + std::to_string(tileRow) + ".png";
+
+			savePng(fileName, level.band.data() + firstColumn, level.bandRows,
+			        std::min(tileSize, level.width - firstColumn), level.width, colormap, limit, 1);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (unsigned t = 1; t < workers; t++)
+		pool.emplace_back(worker);
+	worker();
+	for (std::thread &t : pool)
+		t.join();
+
+	tiles += columns;
+	level.bandStart += level.bandRows;
+	level.bandRows = 0;
+}
+
+TileWriterThread::TileWriterThread(TilePyramid &pyramid, size_t bandRows, size_t width, size_t queuedBands)
+	: pyramid(pyramid), width(width), buffers(queuedBands + 1, std::vector<int>(bandRows * width)),
+	  current(0), done(false)
+{
+	for (size_t b = 0; b < buffers.size(); b++)
+		freeBuffers.push_back(b);
+
+	writer = std::thread(&TileWriterThread::run, this);
+}
+
+TileWriterThread::~TileWriterThread()
+{
+	if (writer.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			done = true;
+		}
+		changed.notify_all();
+		writer.join();
+	}
+}
+
+int *TileWriterThread::band()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	changed.wait(lock, [this]() { return !freeBuffers.empty(); });
+
+	current = freeBuffers.front();
+	freeBuffers.pop_front();
+	return buffers[current].data();
+}
+
+void TileWriterThread::push(size_t rows)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queued.emplace_back(current, rows);
+	}
+	changed.notify_all();
+}
+
+void TileWriterThread::finish()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		done = true;
+	}
+	changed.notify_all();
+	writer.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+void TileWriterThread::run()
+{
+	while (true)
+	{
+		std::pair<size_t, size_t> band;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			changed.wait(lock, [this]() { return !queued.empty() || done; });
+			if (queued.empty())
+				return;
+
+			band = queued.front();
+			queued.pop_front();
+		}
+
+		// After an error the bands are only returned, so the renderer does not block.
+		if (!error)
+		{
+			try
+			{
+				pyramid.addRows(buffers[band.first].data(), band.second);
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			freeBuffers.push_back(band.first);
+		}
+		changed.notify_all();
+	}
+}
@@ -0,0 +1,139 @@
+/**
+ * @file    tile_pyramid.h
+ *
+ * @author  David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ *
+ * @brief   Streaming writer of a tiled multi-resolution image pyramid
+ *
+ * @date    19 October 2026
+ **/
+
+#ifndef TILE_PYRAMID_H
+#define TILE_PYRAMID_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Writes PNG tiles of all zoom levels while the rows of the full resolution image arrive
+ *
+ * Tiles are stored as <directory>/<level>/<column>_<row>.png, level 0 is the coarsest one
+ * (the whole image fits one tile) and every next level doubles the resolution up to the full
+ * size. Coarser levels are built by 2x2 averaging of the finer rows as they come, so only one
+ * band of tile rows per level is kept in memory.
+ */
+class TilePyramid
+{
+public:
+	/**
+	 * @param directory output directory, created if missing
+	 * @param height rows of the full resolution image
+	 * @param width columns of the full resolution image
+	 * @param limit the iteration limit (for the colormap)
+	 * @param tileSize edge of a tile in pixels
+	 * @param threads threads encoding the tiles of a band, 0 = all hardware threads
+	 */
+	TilePyramid(const std::string &directory, size_t height, size_t width, int limit, size_t tileSize = 256, unsigned threads = 0);
+
+	/**
+	 * @brief Adds the next rows of the full resolution image
+	 *
+	 * @param rows count * width iteration counts
+	 */
+	void addRows(const int *rows, size_t count);
+
+	/**
+	 * @brief Checks that the whole image arrived (all tiles are written by then)
+	 */
+	void finish() const;
+
+	int levels() const { return static_cast<int>(pyramid.size()); }
+
+	size_t tilesWritten() const { return tiles; }
+
+private:
+	struct Level
+	{
+		size_t height;
+		size_t width;
+		size_t received; // rows received so far
+		size_t bandStart; // first image row in band
+		size_t bandRows; // rows currently in band
+		std::vector<int> band; // one row of tiles
+		std::vector<int> pending; // even row waiting for its pair
+		bool hasPending;
+	};
+
+	void pushRow(size_t level, const int *row);
+	void writeBand(size_t level);
+
+	const std::string directory;
+	const int limit;
+	const size_t tileSize;
+	const unsigned threads;
+	const std::vector<uint32_t> colormap;
+
+	std::vector<Level> pyramid;
+	size_t tiles;
+};
+
+/**
+ * @brief Passes bands of rows to a TilePyramid on its own thread
+ *
+ * The tiles of a band are encoded while the next band is being rendered. At most
+ * queuedBands bands wait for the writer, band() blocks until one of them is written.
+ */
+class TileWriterThread
+{
+public:
+	/**
+	 * @param bandRows maximal rows of a band
+	 * @param width columns of the full resolution image
+	 */
+	TileWriterThread(TilePyramid &pyramid, size_t bandRows, size_t width, size_t queuedBands = 2);
+	~TileWriterThread();
+
+	TileWriterThread(const TileWriterThread &) = delete;
+	TileWriterThread &operator=(const TileWriterThread &) = delete;
+
+	/**
+	 * @brief Buffer of bandRows * width iteration counts for the next band
+	 */
+	int *band();
+
+	/**
+	 * @brief Queues the first rows of the buffer returned by the last band()
+	 */
+	void push(size_t rows);
+
+	/**
+	 * @brief Waits until all queued bands are written, rethrows the error of the writer
+	 */
+	void finish();
+
+private:
+	void run();
+
+	TilePyramid &pyramid;
+	const size_t width;
+	std::vector<std::vector<int>> buffers;
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<size_t> freeBuffers;
+	std::deque<std::pair<size_t, size_t>> queued; // buffer, rows
+	size_t current; // buffer returned by band()
+	bool done;
+	std::exception_ptr error;
+
+	std::thread writer;
+};
+
+#endif // TILE_PYRAMID_H
@@ -0,0 +1,101 @@
+/**
+ * @file    compare.cc
+ *
+ * @author  David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ *
+ * @brief   Compares two Mandelbrot results (.npz or .npy), native replacement of scripts/compare.py
+ *
+ * @date    19 October 2026
+ **/
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "cxxopts.hpp"
+
+#include "cnpy.h"
+#include "result_compare.h"
+
+/**
+ * @brief Loads the "d" matrix, mapped if the file format allows it
+ **/
+static cnpy::NpyArray loadResult(const std::string &fileName)
+{
+	if (fileName.size() > 4 && fileName.compare(fileName.size() - 4, 4, ".npy") == 0)
+		return cnpy::npy_load_mapped(fileName);
+
+	try
+	{
+		return cnpy::npz_load_mapped(fileName, "d");
+	}
+	catch (const std::runtime_error &)
+	{
+		// compressed entries cannot be mapped
+		return cnpy::npz_load(fileName, "d");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	cxxopts::Options options("AVS: Mandelbrot compare", "Compares two Mandelbrot results with the rules of compare.py");
+	options.add_options()
+		("file1", "Reference result", cxxopts::value<std::string>())
+		("file2", "Compared result", cxxopts::value<std::string>())
+		("n,mismatches", "Number of differing points printed on failure", cxxopts::value<size_t>()->default_value("20"))
+		("t,threads", "Number of threads (0 = all)", cxxopts::value<unsigned>()->default_value("0"))
+		("h,help", "Print help");
+
+	options.positional_help("<FILE1> <FILE2>");
+
+	try
+	{
+		options.parse_positional({"file1", "file2"});
+
+		auto args = options.parse(argc, argv);
+
+		if (args.count("help") || !args.count("file1") || !args.count("file2"))
+		{
+			std::cout << options.help() << std::endl;
+			std::exit(args.count("help") ? 0 : 1);
+		}
+
+		const char *fail = "[\033[91mfail\033[0m]";
+		std::vector<cnpy::NpyArray> results;
+
+		for (const std::string &fileName : {args["file1"].as<std::string>(), args["file2"].as<std::string>()})
+		{
+			try
+			{
+				results.push_back(loadResult(fileName));
+			}
+			catch (const std::exception &e)
+			{
+				std::cout << fail << " Error during loading " << fileName << ": " << e.what() << std::endl;
+				std::exit(1);
+			}
+
+			if (results.back().word_size != sizeof(int) || results.back().shape.size() != 2)
+			{
+				std::cout << fail << " " << fileName << " is not a 2D int32 matrix" << std::endl;
+				std::exit(1);
+			}
+		}
+
+		if (results[0].shape != results[1].shape)
+		{
+			std::cout << fail << " Sizes don't match ((" << results[0].shape[0] << ", " << results[0].shape[1] << ") vs ("
+					  << results[1].shape[0] << ", " << results[1].shape[1] << "))" << std::endl;
+			std::exit(1);
+		}
+
+		bool valid = compareResults(results[0].data<int>(), results[1].data<int>(), results[0].shape[0], results[0].shape[1],
+									args["mismatches"].as<size_t>(), std::cout, args["threads"].as<unsigned>());
+
+		return valid ? 0 : 1;
+	}
+	catch (const cxxopts::OptionException &e)
+	{
+		std::cerr << "Invalid options specified: " << e.what() << std::endl;
+		std::exit(1);
+	}
+}
@@ -0,0 +1,977 @@
+/**
+ * @file    mandel.cc
+ *
+ * @author  David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ *
+ * @brief   libmandel - C API of the Mandelbrot calculators
+ *
+ * @date    19 October 2026
+ **/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "mandel.h"
+
+#include "CalculatorRegistry.h"
+#include "SupersampledMandelCalculator.h"
+#include "ProgressiveMandelCalculator.h"
+
+static_assert(MANDEL_CAP_THREADS == CALCULATOR_THREADS && MANDEL_CAP_EXACT == CALCULATOR_EXACT &&
+              MANDEL_CAP_SIMD == CALCULATOR_SIMD && MANDEL_CAP_SMOOTH == CALCULATOR_SMOOTH,
+              "Capability flags of the C API and of the registry differ");
+
+struct mandel_context
+{
+	std::string calculator;
+
+	uint32_t width = 3072;
+	uint32_t height = 2048;
+	uint32_t limit = 100;
+	uint32_t threads = 1;
+
+	double x_min = -2.0;
+	double x_max = 1.0;
+	double y_min = -1.5;
+	double y_max = 1.5;
+
+	uint32_t first_row = 0;
+	uint32_t window_rows = 0; // 0 = the whole image
+
+	bool half_output = false; // symmetric images are stored as their upper half
+	HugePages huge_pages = HugePages::Off; // of the buffers allocated by the calculators
+
+	uint32_t samples = 0; // 0 = no supersampling
+	float threshold = 0.0f;
+
+	mandel_rows_callback callback = NULL;
+	void *callback_data = NULL;
+
+	mandel_pass_callback pass_callback = NULL;
+	void *pass_callback_data = NULL;
+
+	mandel_stats stats = {};
+	std::string last_error;
+	std::string description;
+
+	std::unique_ptr<BaseMandelCalculator> reference; // for mandel_reference_value, created on demand
+
+	RenderControl *control = NULL; // of the asynchronous render in progress
+};
+
+/**
+ * @brief An asynchronous render, owns the thread running it
+ */
+struct mandel_task
+{
+	mandel_context *context;
+	RenderControl control;
+	std::atomic<bool> done;
+	mandel_status status;
+	std::thread thread;
+};
+
+/**
+ * @brief Rows of the stripes handed out to the rendering threads
+ */
+static constexpr uint32_t defaultStripeRows = 32;
+
+/**
+ * @brief Rows of the stripes of the context
+ *
+ * A page is placed on the NUMA node of the thread touching it first, so with huge pages
+ * a stripe covers at least one page and the page is mostly written by that thread.
+ */
+static uint32_t contextStripeRows(const mandel_context *context)
+{
+	if (context->huge_pages == HugePages::Off)
+		return defaultStripeRows;
+
+	const size_t rowBytes = context->width * sizeof(int32_t);
+	return std::max<uint32_t>(defaultStripeRows, (hugePageSize + rowBytes - 1) / rowBytes);
+}
+
+/**
+ * @brief Creates the calculator of the given registry entry configured by the context
+ */
+static std::unique_ptr<BaseMandelCalculator> createCalculator(const mandel_context *context, const CalculatorInfo &info)
+{
+	const CalculatorParams params = {context->width, context->height, context->limit, context->samples, context->threshold};
+
+	std::unique_ptr<BaseMandelCalculator> calculator(info.create(params));
+	calculator->setViewport(context->x_min, context->x_max, context->y_min, context->y_max);
+	return calculator;
+}
+
+/**
+ * @brief Creates the calculator selected by the context, supersampling overrides the name
+ */
+static std::unique_ptr<BaseMandelCalculator> createCalculator(const mandel_context *context)
+{
+	const CalculatorInfo *info = findCalculator(context->samples > 0 ? "supersampled" : context->calculator);
+	if (!info)
+		throw std::invalid_argument("Unknown calculator (" + context->calculator + ")");
+
+	return createCalculator(context, *info);
+}
+
+// Only the supersampled calculator has smooth values and refines pixels.
+static void copySmooth(const BaseMandelCalculator &calculator, float *smooth, size_t offset, size_t count)
+{
+	const SupersampledMandelCalculator *supersampled = dynamic_cast<const SupersampledMandelCalculator *>(&calculator);
+	if (smooth && supersampled)
+		std::memcpy(smooth + offset, supersampled->smoothResult(), count * sizeof(float));
+}
+
+static double refinedFraction(const BaseMandelCalculator &calculator)
+{
+	const SupersampledMandelCalculator *supersampled = dynamic_cast<const SupersampledMandelCalculator *>(&calculator);
+	return supersampled ? supersampled->refinedFraction() : 1.0;
+}
+
+/**
+ * @brief Number of rows the render writes to the buffer
+ *
+ * The whole image unless a symmetric image is kept as its upper half: the calculators' own
+ * path stores the rows it iterates, the stripes the upper (height + 1) / 2 rows.
+ */
+static uint32_t storedRows(const mandel_context *context)
+{
+	const unsigned threads = context->threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : context->threads;
+
+	if (context->window_rows > 0)
+		return context->window_rows;
+	if (!context->half_output || context->y_min != -context->y_max)
+		return context->height;
+	if (threads > 1)
+		return (context->height + 1) / 2;
+
+	std::unique_ptr<BaseMandelCalculator> calculator = createCalculator(context);
+	calculator->setHalfOutput(true);
+	return calculator->storedRows();
+}
+
+/**
+ * @brief Renders the context into buffer (and smooth if not NULL)
+ *
+ * One thread renders the whole image with the calculator's own symmetric path and streams
+ * the rows to the callback. More threads (or a row window) take stripes of contextStripeRows rows
+ * from a shared counter, every thread with its own calculator instance; the stripes of the
+ * upper half are mirrored by the thread that computed them.
+ */
+static void renderWith(mandel_context *context, int32_t *buffer, float *smooth)
+{
+	const size_t width = context->width;
+	const bool window = context->window_rows > 0;
+	const uint32_t rows = window ? context->window_rows : context->height;
+	const bool symmetric = context->y_min == -context->y_max;
+	unsigned threads = context->threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : context->threads;
+
+	if (threads == 1 && !window)
+	{
+		HugePagesScope pages(context->huge_pages);
+		std::unique_ptr<BaseMandelCalculator> calculator = createCalculator(context);
+		calculator->setOutputBuffer(buffer);
+		calculator->setHalfOutput(context->half_output);
+		calculator->setRenderControl(context->control);
+		if (context->control)
+			context->control->totalRows = calculator->computedRows();
+
+		if (context->callback)
+		{
+			calculator->setRowCallback([context](const int *rows, int firstRow, int lastRow) {
+				context->callback(rows, firstRow, lastRow, context->callback_data);
+			});
+		}
+
+		ProgressiveMandelCalculator *progressive = dynamic_cast<ProgressiveMandelCalculator *>(calculator.get());
+		if (progressive && context->pass_callback)
+		{
+			progressive->setPassCallback([context](const int *data, int stride) {
+				context->pass_callback(data, stride, context->pass_callback_data);
+			});
+		}
+
+		calculator->calculateMandelbrot();
+		copySmooth(*calculator, smooth, 0, calculator->storedRows() * width);
+
+		context->stats.computed_rows = calculator->computedRows();
+		context->stats.refined_fraction = refinedFraction(*calculator);
+		context->stats.threads = 1;
+		return;
+	}
+
+	const bool upperHalf = !window && symmetric;
+	const bool mirror = upperHalf && !context->half_output;
+	const uint32_t computed = upperHalf ? (context->height + 1) / 2 : rows;
+	const uint32_t firstRow = window ? context->first_row : 0;
+	const uint32_t stripeRows = contextStripeRows(context);
+	threads = std::max(1u, std::min(threads, (computed + stripeRows - 1) / stripeRows));
+	if (context->control)
+		context->control->totalRows = computed;
+
+	std::atomic<uint32_t> nextStripe(0);
+	std::vector<double> refined(threads, 0.0);
+	std::exception_ptr error;
+	std::mutex errorMutex;
+
+	auto worker = [&](unsigned t) {
+		try
+		{
+			// The scratch buffers are allocated and first touched by the thread using them.
+			HugePagesScope pages(context->huge_pages);
+			std::unique_ptr<BaseMandelCalculator> calculator = createCalculator(context);
+			calculator->setRenderControl(context->control);
+			uint32_t start;
+
+			while ((start = nextStripe.fetch_add(stripeRows)) < computed)
+			{
+				const uint32_t count = std::min(stripeRows, computed - start);
+
+				calculator->setOutputBuffer(buffer + start * width);
+				calculator->setRowWindow(firstRow + start, count);
+				calculator->calculateMandelbrot();
+				copySmooth(*calculator, smooth, start * width, count * width);
+				refined[t] += refinedFraction(*calculator) * count;
+
+				for (uint32_t r = start; mirror && r < start + count; r++)
+				{
+					const size_t mirrorRow = context->height - r - 1;
+					if (mirrorRow < computed)
+						continue;
+
+					std::memcpy(buffer + mirrorRow * width, buffer + r * width, width * sizeof(int32_t));
+					if (smooth)
+						std::memcpy(smooth + mirrorRow * width, smooth + r * width, width * sizeof(float));
+				}
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(errorMutex);
+			if (!error)
+				error = std::current_exception();
+			// The other threads stop after their current stripe.
+			nextStripe = computed;
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (unsigned t = 1; t < threads; t++)
+		pool.emplace_back(worker, t);
+	worker(0);
+	for (std::thread &t : pool)
+		t.join();
+
+	if (error)
+		std::rethrow_exception(error);
+
+	double refinedRows = 0.0;
+	for (double r : refined)
+		refinedRows += r;
+
+	context->stats.computed_rows = computed;
+	context->stats.refined_fraction = refinedRows / computed;
+	context->stats.threads = threads;
+
+	if (context->callback)
+		context->callback(buffer, 0, upperHalf && !mirror ? computed : rows, context->callback_data);
+}
+
+/**
+ * @brief Runs fn and converts its exceptions to a status, the message goes to last_error
+ */
+template <typename F>
+static mandel_status guarded(mandel_context *context, F fn)
+{
+	try
+	{
+		fn();
+		context->last_error.clear();
+		return MANDEL_OK;
+	}
+	catch (const RenderCancelled &e)
+	{
+		context->last_error = e.what();
+		return MANDEL_CANCELLED;
+	}
+	catch (const std::bad_alloc &)
+	{
+		context->last_error = "Out of memory";
+		return MANDEL_OUT_OF_MEMORY;
+	}
+	catch (const std::range_error &e)
+	{
+		context->last_error = e.what();
+		return MANDEL_INVALID_ARGUMENT;
+	}
+	catch (const std::invalid_argument &e)
+	{
+		context->last_error = e.what();
+		return MANDEL_INVALID_ARGUMENT;
+	}
+	catch (const std::exception &e)
+	{
+		context->last_error = e.what();
+		return MANDEL_RENDER_FAILED;
+	}
+}
+
+static mandel_status fail(mandel_context *context, mandel_status status, const std::string &message)
+{
+	context->last_error = message;
+	return status;
+}
+
+/**
+ * @brief Copies value into the caller's structure of out->struct_size bytes
+ *
+ * A caller built against an older header has a shorter structure and gets only its fields.
+ */
+template <typename T>
+static mandel_status copyOut(T *out, T value)
+{
+	const size_t size = std::min<size_t>(out->struct_size, sizeof(T));
+	if (size < sizeof(value.struct_size))
+		return MANDEL_INVALID_ARGUMENT;
+
+	value.struct_size = static_cast<uint32_t>(size);
+	std::memcpy(out, &value, size);
+	return MANDEL_OK;
+}
+
+uint32_t mandel_api_version(void)
+{
+	return MANDEL_API_VERSION;
+}
+
+const char *mandel_status_string(mandel_status status)
+{
+	switch (status)
+	{
+	case MANDEL_OK:
+		return "ok";
+	case MANDEL_INVALID_ARGUMENT:
+		return "invalid argument";
+	case MANDEL_UNKNOWN_CALCULATOR:
+		return "unknown calculator";
+	case MANDEL_BUFFER_TOO_SMALL:
+		return "buffer too small";
+	case MANDEL_OUT_OF_MEMORY:
+		return "out of memory";
+	case MANDEL_RENDER_FAILED:
+		return "render failed";
+	case MANDEL_CANCELLED:
+		return "cancelled";
+	}
+	return "unknown status";
+}
+
+mandel_status mandel_create(const char *calculator, mandel_context **context)
+{
+	if (!calculator || !context)
+		return MANDEL_INVALID_ARGUMENT;
+
+	*context = NULL;
+	if (!findCalculator(calculator))
+		return MANDEL_UNKNOWN_CALCULATOR;
+
+	*context = new (std::nothrow) mandel_context();
+	if (!*context)
+		return MANDEL_OUT_OF_MEMORY;
+
+	(*context)->calculator = calculator;
+	return MANDEL_OK;
+}
+
+void mandel_destroy(mandel_context *context)
+{
+	delete context;
+}
+
+mandel_status mandel_set_size(mandel_context *context, uint32_t width, uint32_t height)
+{
+	if (!context)
+		return MANDEL_INVALID_ARGUMENT;
+	// The steps are (max - min) / (size - 1).
+	if (width < 2 || height < 2 || width > INT32_MAX || height > INT32_MAX)
+		return fail(context, MANDEL_INVALID_ARGUMENT, "Image has to be at least 2 x 2 points");
+
+	context->width = width;
+	context->height = height;
+	context->window_rows = 0;
+	context->reference.reset();
+	return MANDEL_OK;
+}
+
+mandel_status mandel_set_viewport(mandel_context *context, double x_min, double x_max, double y_min, double y_max)
+{
+	if (!context)
+		return MANDEL_INVALID_ARGUMENT;
+	if (!(x_min < x_max) || !(y_min < y_max))
+		return fail(context, MANDEL_INVALID_ARGUMENT, "Viewport has to be non-empty");
+
+	context->x_min = x_min;
+	context->x_max = x_max;
+	context->y_min = y_min;
+	context->y_max = y_max;
+	context->reference.reset();
+	return MANDEL_OK;
+}
+
+mandel_status mandel_set_limit(mandel_context *context, uint32_t limit)
+{
+	if (!context)
+		return MANDEL_INVALID_ARGUMENT;
+	if (limit > INT32_MAX)
+		return fail(context, MANDEL_INVALID_ARGUMENT, "Iteration limit is too large");
+
+	context->limit = limit;
+	context->reference.reset();
+	return MANDEL_OK;
+}
+
+mandel_status mandel_set_threads(mandel_context *context, uint32_t threads)
+{
+	if (!context)
+		return MANDEL_INVALID_ARGUMENT;
+
+	context->threads = threads;
+	return MANDEL_OK;
+}
+
+mandel_status mandel_set_row_window(mandel_context *context, uint32_t first_row, uint32_t rows)
+{
+	if (!context)
+		return MANDEL_INVALID_ARGUMENT;
+	if (static_cast<uint64_t>(first_row) + rows > context->height)
+		return fail(context, MANDEL_INVALID_ARGUMENT, "Row window exceeds the image");
+
+	context->first_row = first_row;
+	context->window_rows = rows;
+	return MANDEL_OK;
+}
+
+mandel_status mandel_set_supersampling(mandel_context *context, uint32_t samples, float threshold)
+{
+	if (!context)
+		return MANDEL_INVALID_ARGUMENT;
+	if (samples > 64 || !(threshold >= 0.0f))
+		return fail(context, MANDEL_INVALID_ARGUMENT, "Supersampling needs 0 to 64 samples and a non-negative threshold");
+
+	context->samples = samples;
+	context->threshold = threshold;
+	return MANDEL_OK;
+}
+
+mandel_status mandel_set_half_output(mandel_context *context, int enable)
+{
+	if (!context)
+		return MANDEL_INVALID_ARGUMENT;
+
+	context->half_output = enable != 0;
+	return MANDEL_OK;
+}
+
+mandel_status mandel_set_huge_pages(mandel_context *context, mandel_huge_pages mode)
+{
+	if (!context)
+		return MANDEL_INVALID_ARGUMENT;
+
+	switch (mode)
+	{
+	case MANDEL_HUGE_PAGES_OFF:
+		context->huge_pages = HugePages::Off;
+		break;
+	case MANDEL_HUGE_PAGES_TRANSPARENT:
+		context->huge_pages = HugePages::Transparent;
+		break;
+	case MANDEL_HUGE_PAGES_EXPLICIT:
+		context->huge_pages = HugePages::Explicit;
+		break;
+	default:
+		return fail(context, MANDEL_INVALID_ARGUMENT, "Unknown huge page mode");
+	}
+	return MANDEL_OK;
+}
+
+void *mandel_alloc_buffer(const mandel_context *context, size_t bytes)
+{
+	if (!context)
+		return NULL;
+
+	try
+	{
+		HugePagesScope pages(context->huge_pages);
+		return allocBuffer(bytes);
+	}
+	catch (const std::bad_alloc &)
+	{
+		return NULL;
+	}
+}
+
+void mandel_free_buffer(void *buffer)
+{
+	freeBuffer(buffer);
+}
+
+mandel_status mandel_get_output_layout(mandel_context *context, mandel_output_layout *layout)
+{
+	if (!context || !layout)
+		return MANDEL_INVALID_ARGUMENT;
+
+	mandel_output_layout value = {};
+	const mandel_status status = guarded(context, [&]() {
+		value.rows = context->window_rows > 0 ? context->window_rows : context->height;
+		value.stored_rows = storedRows(context);
+	});
+	if (status != MANDEL_OK)
+		return status;
+
+	return copyOut(layout, value);
+}
+
+mandel_status mandel_set_row_callback(mandel_context *context, mandel_rows_callback callback, void *user_data)
+{
+	if (!context)
+		return MANDEL_INVALID_ARGUMENT;
+
+	context->callback = callback;
+	context->callback_data = user_data;
+	return MANDEL_OK;
+}
+
+mandel_status mandel_set_pass_callback(mandel_context *context, mandel_pass_callback callback, void *user_data)
+{
+	if (!context)
+		return MANDEL_INVALID_ARGUMENT;
+
+	context->pass_callback = callback;
+	context->pass_callback_data = user_data;
+	return MANDEL_OK;
+}
+
+/**
+ * @brief Common part of mandel_render and mandel_render_smooth
+ */
+static mandel_status render(mandel_context *context, int32_t *buffer, float *smooth)
+{
+	return guarded(context, [&]() {
+		const size_t rows = storedRows(context);
+		const PageFaultCounter pageFaults;
+		const auto startTime = std::chrono::steady_clock::now();
+
+		renderWith(context, buffer, smooth);
+
+		context->stats.page_faults = pageFaults.faults();
+		context->stats.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		context->stats.pixels = rows * context->width;
+	});
+}
+
+/**
+ * @brief Checks that the buffer holds the rendered rows
+ *
+ * @param rows if not NULL, receives the number of rows the render writes
+ */
+static mandel_status checkBuffer(mandel_context *context, const void *buffer, size_t buffer_size, size_t *rows = NULL)
+{
+	if (!context || !buffer)
+		return MANDEL_INVALID_ARGUMENT;
+
+	size_t stored = 0;
+	const mandel_status status = guarded(context, [&]() { stored = storedRows(context); });
+	if (status != MANDEL_OK)
+		return status;
+	if (rows)
+		*rows = stored;
+
+	if (buffer_size < stored * context->width)
+		return fail(context, MANDEL_BUFFER_TOO_SMALL, "Buffer is smaller than width * rows");
+
+	return MANDEL_OK;
+}
+
+mandel_status mandel_render(mandel_context *context, int32_t *buffer, size_t buffer_size)
+{
+	const mandel_status status = checkBuffer(context, buffer, buffer_size);
+	if (status != MANDEL_OK)
+		return status;
+
+	return render(context, buffer, NULL);
+}
+
+mandel_status mandel_render_async(mandel_context *context, int32_t *buffer, size_t buffer_size, mandel_task **task)
+{
+	if (!task)
+		return MANDEL_INVALID_ARGUMENT;
+
+	*task = NULL;
+	const mandel_status status = checkBuffer(context, buffer, buffer_size);
+	if (status != MANDEL_OK)
+		return status;
+	if (context->control)
+		return fail(context, MANDEL_INVALID_ARGUMENT, "Context is already rendering");
+
+	mandel_task *started = new (std::nothrow) mandel_task();
+	if (!started)
+		return fail(context, MANDEL_OUT_OF_MEMORY, "Out of memory");
+
+	started->context = context;
+	started->done = false;
+	started->status = MANDEL_OK;
+	context->control = &started->control;
+
+	try
+	{
+		started->thread = std::thread([started, buffer]() {
+			started->status = render(started->context, buffer, NULL);
+			started->done = true;
+		});
+	}
+	catch (const std::system_error &e)
+	{
+		context->control = NULL;
+		delete started;
+		return fail(context, MANDEL_RENDER_FAILED, e.what());
+	}
+
+	*task = started;
+	return MANDEL_OK;
+}
+
+void mandel_task_cancel(mandel_task *task)
+{
+	if (task)
+		task->control.cancelled = true;
+}
+
+mandel_status mandel_task_progress(const mandel_task *task, uint64_t *rows_done, uint64_t *rows_total)
+{
+	if (!task || !rows_done || !rows_total)
+		return MANDEL_INVALID_ARGUMENT;
+
+	*rows_done = task->control.computedRows.load(std::memory_order_relaxed);
+	*rows_total = task->control.totalRows.load(std::memory_order_relaxed);
+	return MANDEL_OK;
+}
+
+int mandel_task_done(const mandel_task *task)
+{
+	return task && task->done;
+}
+
+mandel_status mandel_task_wait(mandel_task *task)
+{
+	if (!task)
+		return MANDEL_INVALID_ARGUMENT;
+
+	task->thread.join();
+	task->context->control = NULL;
+
+	const mandel_status status = task->status;
+	delete task;
+	return status;
+}
+
+mandel_status mandel_render_smooth(mandel_context *context, float *buffer, size_t buffer_size)
+{
+	size_t rows;
+	mandel_status status = checkBuffer(context, buffer, buffer_size, &rows);
+	if (status != MANDEL_OK)
+		return status;
+	const CalculatorInfo *info = findCalculator(context->calculator);
+	if (context->samples == 0 && !(info->capabilities & CALCULATOR_SMOOTH))
+		return fail(context, MANDEL_INVALID_ARGUMENT, "Smooth rendering needs mandel_set_supersampling");
+
+	// The calculators always produce the rounded counts as well.
+	int32_t *counts;
+	try
+	{
+		HugePagesScope pages(context->huge_pages);
+		counts = allocArray<int32_t>(rows * context->width);
+	}
+	catch (const std::bad_alloc &)
+	{
+		return fail(context, MANDEL_OUT_OF_MEMORY, "Out of memory");
+	}
+
+	status = render(context, counts, buffer);
+	freeBuffer(counts);
+	return status;
+}
+
+mandel_status mandel_get_stats(const mandel_context *context, mandel_stats *stats)
+{
+	if (!context || !stats)
+		return MANDEL_INVALID_ARGUMENT;
+
+	return copyOut(stats, context->stats);
+}
+
+int32_t mandel_reference_value(mandel_context *context, uint32_t row, uint32_t column)
+{
+	if (!context || row >= context->height || column >= context->width)
+		return -1;
+
+	int32_t value = -1;
+	guarded(context, [&]() {
+		if (!context->reference)
+			context->reference = createCalculator(context, *findCalculator("ref"));
+
+		value = context->reference->referenceValue(row, column);
+	});
+
+	return value;
+}
+
+const char *mandel_describe(mandel_context *context, int batch_mode)
+{
+	if (!context)
+		return "";
+
+	const mandel_status status = guarded(context, [&]() {
+		std::ostringstream out;
+		createCalculator(context)->info(out, batch_mode != 0);
+		context->description = out.str();
+	});
+	if (status != MANDEL_OK)
+		context->description.clear();
+
+	return context->description.c_str();
+}
+
+const char *mandel_last_error(const mandel_context *context)
+{
+	return context ? context->last_error.c_str() : "";
+}
+
+uint32_t mandel_calculator_count(void)
+{
+	return calculatorRegistry().size();
+}
+
+mandel_status mandel_calculator_info(uint32_t index, mandel_calculator_desc *desc)
+{
+	if (!desc || index >= calculatorRegistry().size())
+		return MANDEL_INVALID_ARGUMENT;
+
+	const CalculatorInfo &info = calculatorRegistry()[index];
+	mandel_calculator_desc value = {};
+	value.name = info.name.c_str();
+	value.description = info.description.c_str();
+	value.capabilities = info.capabilities;
+	value.precision = info.precision.c_str();
+	value.dtype = info.dtype.c_str();
+	value.isa = info.isa.c_str();
+	value.cost_hint = info.costHint;
+	return copyOut(desc, value);
+}
+
+/**
+ * @brief An image size and limit of the benchmark profile
+ */
+struct ProfilePoint
+{
+	uint32_t width;
+	uint32_t height;
+	uint32_t limit;
+
+	bool operator==(const ProfilePoint &other) const
+	{
+		return width == other.width && height == other.height && limit == other.limit;
+	}
+};
+
+/**
+ * @brief Points measured by mandel_benchmark around the given one
+ *
+ * Lower limits are measured on the whole image, higher ones on smaller images,
+ * so no point costs much more than the given one.
+ */
+static std::vector<ProfilePoint> benchmarkPoints(uint32_t width, uint32_t height, uint32_t limit)
+{
+	std::vector<ProfilePoint> points;
+
+	for (const double factor : {1.0 / 16, 1.0 / 4, 1.0, 4.0, 16.0})
+	{
+		const double scale = factor > 1.0 ? 1.0 / std::sqrt(factor) : 1.0;
+		const ProfilePoint point = {std::max(2u, static_cast<uint32_t>(width * scale)),
+		                            std::max(2u, static_cast<uint32_t>(height * scale)),
+		                            std::max(1u, static_cast<uint32_t>(std::lround(limit * factor)))};
+
+		if (std::find(points.begin(), points.end(), point) == points.end())
+			points.push_back(point);
+	}
+
+	return points;
+}
+
+/**
+ * @brief How much two points differ, in orders of magnitude of the limit and the pixel count
+ *
+ * The limit decides which kernel wins (escape checks, unrolling), the size mostly changes
+ * the cache behaviour, so it weighs less.
+ */
+static double profileDistance(const ProfilePoint &a, const ProfilePoint &b)
+{
+	const double pixels = (static_cast<double>(a.width) * a.height) / (static_cast<double>(b.width) * b.height);
+	return std::abs(std::log(static_cast<double>(a.limit) / b.limit)) + 0.25 * std::abs(std::log(pixels));
+}
+
+mandel_status mandel_benchmark(const char *profile_path, uint32_t width, uint32_t height, uint32_t limit)
+{
+	if (!profile_path || limit == 0)
+		return MANDEL_INVALID_ARGUMENT;
+
+	std::ofstream profile(profile_path);
+	if (!profile)
+		return MANDEL_INVALID_ARGUMENT;
+
+	profile << "# calculator;ns per point;width;height;limit" << std::endl;
+
+	for (const ProfilePoint &point : benchmarkPoints(width, height, limit))
+	{
+		const size_t pixels = static_cast<size_t>(point.width) * point.height;
+		std::unique_ptr<int32_t[]> buffer(new (std::nothrow) int32_t[pixels]);
+		if (!buffer)
+			return MANDEL_OUT_OF_MEMORY;
+
+		for (const CalculatorInfo &info : calculatorRegistry())
+		{
+			if (info.capabilities & CALCULATOR_SMOOTH)
+				continue;
+
+			mandel_context *context;
+			mandel_status status = mandel_create(info.name.c_str(), &context);
+			if (status != MANDEL_OK)
+				return status;
+
+			status = mandel_set_size(context, point.width, point.height);
+			if (status == MANDEL_OK)
+				status = mandel_set_limit(context, point.limit);
+			if (status == MANDEL_OK)
+				status = mandel_render(context, buffer.get(), pixels);
+
+			if (status == MANDEL_OK)
+				profile << info.name << ";" << context->stats.elapsed_ms * 1e6 / context->stats.pixels << ";"
+				        << point.width << ";" << point.height << ";" << point.limit << std::endl;
+
+			mandel_destroy(context);
+			if (status != MANDEL_OK)
+				return status;
+		}
+	}
+
+	return profile ? MANDEL_OK : MANDEL_RENDER_FAILED;
+}
+
+mandel_status mandel_select_calculator(const char *profile_path, uint32_t width, uint32_t height, uint32_t limit,
+                                       const char **name, int *from_profile)
+{
+	if (!name || width == 0 || height == 0 || limit == 0)
+		return MANDEL_INVALID_ARGUMENT;
+
+	// Only calculators whose output is the same as the reference one are candidates.
+	auto candidate = [](const CalculatorInfo &info) {
+		return (info.capabilities & CALCULATOR_EXACT) && !(info.capabilities & CALCULATOR_SMOOTH);
+	};
+
+	// Measured times per point of the candidates, missing or unreadable profile leaves it empty.
+	struct Measurement
+	{
+		const CalculatorInfo *info;
+		double cost;
+		ProfilePoint point;
+	};
+	std::vector<Measurement> measured;
+
+	std::ifstream profile(profile_path ? profile_path : "");
+	std::string line;
+	while (std::getline(profile, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::vector<std::string> fields;
+		std::istringstream stream(line);
+		std::string field;
+		while (std::getline(stream, field, ';'))
+			fields.push_back(field);
+
+		const CalculatorInfo *info = fields.size() == 5 ? findCalculator(fields[0]) : NULL;
+		if (!info || !candidate(*info))
+			continue;
+
+		try
+		{
+			const Measurement measurement = {info, std::stod(fields[1]),
+			                                 {static_cast<uint32_t>(std::stoul(fields[2])), static_cast<uint32_t>(std::stoul(fields[3])),
+			                                  static_cast<uint32_t>(std::stoul(fields[4]))}};
+			if (measurement.point.width > 0 && measurement.point.height > 0 && measurement.point.limit > 0)
+				measured.push_back(measurement);
+		}
+		catch (const std::exception &)
+		{
+		}
+	}
+
+	// The calculators are compared at the measured point closest to the requested image.
+	const ProfilePoint requested = {width, height, limit};
+	const ProfilePoint *closest = NULL;
+	for (const Measurement &measurement : measured)
+	{
+		if (!closest || profileDistance(measurement.point, requested) < profileDistance(*closest, requested))
+			closest = &measurement.point;
+	}
+
+	const CalculatorInfo *best = NULL;
+	double bestCost = std::numeric_limits<double>::infinity();
+
+	if (closest)
+	{
+		for (const Measurement &measurement : measured)
+		{
+			if (measurement.point == *closest && measurement.cost < bestCost)
+			{
+				best = measurement.info;
+				bestCost = measurement.cost;
+			}
+		}
+	}
+	else
+	{
+		for (const CalculatorInfo &info : calculatorRegistry())
+		{
+			if (candidate(info) && info.costHint < bestCost)
+			{
+				best = &info;
+				bestCost = info.costHint;
+			}
+		}
+	}
+
+	if (!best)
+		return MANDEL_UNKNOWN_CALCULATOR;
+
+	*name = best->name.c_str();
+	if (from_profile)
+		*from_profile = closest != NULL;
+	return MANDEL_OK;
+}
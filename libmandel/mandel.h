@@ -0,0 +1,296 @@
+/**
+ * @file    mandel.h
+ *
+ * @author  David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ *
+ * @brief   libmandel - C API of the Mandelbrot calculators
+ *
+ *          Usage: mandel_create a context for a calculator, change the defaults
+ *          with the mandel_set_* functions, mandel_render into a caller owned
+ *          buffer (any number of times) and mandel_destroy the context.
+ *
+ *          The context is an opaque handle. The structures filled by the
+ *          library start with struct_size, set by the caller to the size of
+ *          its structure; only that many bytes are written, so fields added
+ *          at the end need no new version. Any other change of the API
+ *          increments MANDEL_API_VERSION, a program has to be used only with
+ *          the library whose mandel_api_version() equals the MANDEL_API_VERSION
+ *          it was built with. A context must not be used from more threads
+ *          at once, different contexts are independent.
+ *
+ * @date    19 October 2026
+ **/
+
+#ifndef MANDEL_H
+#define MANDEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Version of this header, compare with mandel_api_version() at run time. */
+#define MANDEL_API_VERSION 3
+
+typedef struct mandel_context mandel_context;
+
+/** An asynchronous render started by mandel_render_async. */
+typedef struct mandel_task mandel_task;
+
+typedef enum mandel_status
+{
+    MANDEL_OK = 0,
+    MANDEL_INVALID_ARGUMENT = 1,    /**< bad parameter, see mandel_last_error */
+    MANDEL_UNKNOWN_CALCULATOR = 2,  /**< no calculator of the given name */
+    MANDEL_BUFFER_TOO_SMALL = 3,    /**< the output buffer cannot hold the rendered rows */
+    MANDEL_OUT_OF_MEMORY = 4,
+    MANDEL_RENDER_FAILED = 5,       /**< any other error, see mandel_last_error */
+    MANDEL_CANCELLED = 6            /**< the render was cancelled by mandel_task_cancel */
+} mandel_status;
+
+/** Capability flags of a calculator. */
+#define MANDEL_CAP_THREADS 0x1  /**< instances can render stripes of one image in parallel */
+#define MANDEL_CAP_EXACT 0x2    /**< bit-identical to the reference calculator */
+#define MANDEL_CAP_SIMD 0x4     /**< vectorized kernel */
+#define MANDEL_CAP_SMOOTH 0x8   /**< renders smooth (float) iteration counts */
+
+/** Description of a registered calculator, the strings are static. */
+typedef struct mandel_calculator_desc
+{
+    uint32_t struct_size;       /**< set by the caller to sizeof(mandel_calculator_desc) */
+    const char *name;           /**< name for mandel_create */
+    const char *description;
+    uint32_t capabilities;      /**< MANDEL_CAP_* flags */
+    const char *precision;      /**< arithmetic of the kernel */
+    const char *dtype;          /**< type of the produced values */
+    const char *isa;            /**< instruction set the kernel is built for */
+    double cost_hint;           /**< relative time per point, the reference calculator is 1 */
+} mandel_calculator_desc;
+
+/** Statistics of the last render. */
+typedef struct mandel_stats
+{
+    uint32_t struct_size;       /**< set by the caller to sizeof(mandel_stats) */
+    double elapsed_ms;          /**< wall time of the render */
+    uint64_t pixels;            /**< pixels written to the buffer */
+    uint64_t computed_rows;     /**< rows iterated, the rest was mirrored */
+    uint32_t threads;           /**< threads used */
+    double refined_fraction;    /**< supersampled pixels (adaptive anti-aliasing), 1 otherwise */
+    uint64_t page_faults;       /**< page faults of the rendering threads */
+} mandel_stats;
+
+/** Page size of the large buffers, see mandel_set_huge_pages. */
+typedef enum mandel_huge_pages
+{
+    MANDEL_HUGE_PAGES_OFF = 0,          /**< pages of the system default size */
+    MANDEL_HUGE_PAGES_TRANSPARENT = 1,  /**< 2 MiB transparent huge pages (madvise) */
+    MANDEL_HUGE_PAGES_EXPLICIT = 2      /**< 2 MiB pages of the hugetlbfs pool, transparent ones if it is empty */
+} mandel_huge_pages;
+
+/**
+ * @brief Rows of the rendered image and of the buffer
+ *
+ * Row r >= stored_rows of the image is row rows - r - 1 of the buffer (an image symmetric
+ * around the real axis kept as its upper half, see mandel_set_half_output).
+ */
+typedef struct mandel_output_layout
+{
+    uint32_t struct_size;       /**< set by the caller to sizeof(mandel_output_layout) */
+    uint32_t rows;              /**< rows of the image */
+    uint32_t stored_rows;       /**< rows written to the buffer */
+} mandel_output_layout;
+
+/**
+ * @brief Called with the final rows [first_row, last_row) of the buffer, in order
+ *
+ * Single-threaded renders report the rows while the image is being computed,
+ * multi-threaded ones report all rows when the render is done.
+ *
+ * @param rows the first reported row in the render buffer
+ */
+typedef void (*mandel_rows_callback)(const int32_t *rows, uint32_t first_row, uint32_t last_row, void *user_data);
+
+/**
+ * @brief Called after every pass of a progressive render with the whole preview
+ *
+ * @param buffer the render buffer, points not computed yet repeat the computed one above-left of them
+ * @param stride distance of the computed points, 1 for the final image
+ */
+typedef void (*mandel_pass_callback)(const int32_t *buffer, uint32_t stride, void *user_data);
+
+/** @brief Version of the library, MANDEL_API_VERSION it was built with. */
+uint32_t mandel_api_version(void);
+
+/** @brief Human readable name of a status code. */
+const char *mandel_status_string(mandel_status status);
+
+/**
+ * @brief Creates a context for the calculator of the given name (ref, line, batch, ...),
+ *        see mandel_calculator_info
+ *
+ * Defaults: 3072 x 2048 points, viewport x -2..1, y -1.5..1.5, 100 iterations, 1 thread.
+ */
+mandel_status mandel_create(const char *calculator, mandel_context **context);
+
+void mandel_destroy(mandel_context *context);
+
+mandel_status mandel_set_size(mandel_context *context, uint32_t width, uint32_t height);
+
+/** @brief A viewport symmetric around the real axis is computed as a mirrored half. */
+mandel_status mandel_set_viewport(mandel_context *context, double x_min, double x_max, double y_min, double y_max);
+
+mandel_status mandel_set_limit(mandel_context *context, uint32_t limit);
+
+/** @brief Number of rendering threads, 0 = all hardware threads. */
+mandel_status mandel_set_threads(mandel_context *context, uint32_t threads);
+
+/**
+ * @brief Renders only rows [first_row, first_row + rows) of the image, rows = 0 renders all
+ *
+ * The values are the same as in the whole image; used for out-of-core rendering.
+ */
+mandel_status mandel_set_row_window(mandel_context *context, uint32_t first_row, uint32_t rows);
+
+/**
+ * @brief Switches to anti-aliased rendering: samples x samples smooth subsamples per pixel
+ *
+ * @param threshold supersample only pixels differing from a neighbour by more than this, 0 = all
+ * @param samples 0 switches back to the calculator of the context
+ */
+mandel_status mandel_set_supersampling(mandel_context *context, uint32_t samples, float threshold);
+
+/**
+ * @brief Keeps an image symmetric around the real axis as its upper half, the lower one is not written
+ *
+ * The buffer then needs only stored_rows * width elements, see mandel_get_output_layout.
+ * Other images are rendered whole.
+ */
+mandel_status mandel_set_half_output(mandel_context *context, int enable);
+
+/**
+ * @brief Page size of the buffers of the calculators and of mandel_alloc_buffer
+ *
+ * Multi-threaded renders hand out stripes of at least one huge page, every page is
+ * first touched (and placed on its NUMA node) by the thread computing it.
+ */
+mandel_status mandel_set_huge_pages(mandel_context *context, mandel_huge_pages mode);
+
+/**
+ * @brief Allocates a 64-byte aligned render buffer with the page size of the context
+ *
+ * The memory is not touched, so the rendering threads place its pages.
+ *
+ * @return NULL if out of memory, release it with mandel_free_buffer
+ */
+void *mandel_alloc_buffer(const mandel_context *context, size_t bytes);
+void mandel_free_buffer(void *buffer);
+
+/** @brief Layout of the buffer written by the next render. */
+mandel_status mandel_get_output_layout(mandel_context *context, mandel_output_layout *layout);
+
+mandel_status mandel_set_row_callback(mandel_context *context, mandel_rows_callback callback, void *user_data);
+
+/**
+ * @brief Reports the passes of the progressive calculator, only single-threaded whole-image renders have passes
+ */
+mandel_status mandel_set_pass_callback(mandel_context *context, mandel_pass_callback callback, void *user_data);
+
+/**
+ * @brief Renders the iteration counts into buffer (row-major, width * stored rows of mandel_get_output_layout)
+ *
+ * @param buffer_size number of elements of the buffer
+ */
+mandel_status mandel_render(mandel_context *context, int32_t *buffer, size_t buffer_size);
+
+/**
+ * @brief Starts mandel_render in a background thread
+ *
+ * The context and the buffer must not be used until mandel_task_wait returns.
+ *
+ * @param task receives the handle of the render, has to be passed to mandel_task_wait
+ */
+mandel_status mandel_render_async(mandel_context *context, int32_t *buffer, size_t buffer_size, mandel_task **task);
+
+/**
+ * @brief Asks the render to stop, it does so after the row (or SIMD block) being computed
+ *
+ * The buffer of a cancelled render is only partially written. May be called from any thread.
+ */
+void mandel_task_cancel(mandel_task *task);
+
+/**
+ * @brief Rows iterated so far out of the rows the render iterates (the mirrored half is not counted)
+ */
+mandel_status mandel_task_progress(const mandel_task *task, uint64_t *rows_done, uint64_t *rows_total);
+
+/** @brief 1 if the render has finished (or stopped after a cancel), 0 otherwise. */
+int mandel_task_done(const mandel_task *task);
+
+/**
+ * @brief Waits for the render and frees the task
+ *
+ * @return status of the render, MANDEL_CANCELLED if it was cancelled before it finished
+ */
+mandel_status mandel_task_wait(mandel_task *task);
+
+/**
+ * @brief Renders the smooth iteration counts, requires mandel_set_supersampling
+ */
+mandel_status mandel_render_smooth(mandel_context *context, float *buffer, size_t buffer_size);
+
+/**
+ * @brief Statistics of the last render
+ *
+ * Only stats->struct_size bytes are written, so a structure of an older header gets the fields it has.
+ */
+mandel_status mandel_get_stats(const mandel_context *context, mandel_stats *stats);
+
+/**
+ * @brief Computes one point of the whole image with the scalar reference algorithm
+ */
+int32_t mandel_reference_value(mandel_context *context, uint32_t row, uint32_t column);
+
+/**
+ * @brief Description of the rendering calculator, batch_mode != 0 gives the compact CSV prefix
+ *
+ * The string is valid until the next call with the same context.
+ */
+const char *mandel_describe(mandel_context *context, int batch_mode);
+
+/** @brief Number of registered calculators. */
+uint32_t mandel_calculator_count(void);
+
+/** @brief Describes the index-th registered calculator. */
+mandel_status mandel_calculator_info(uint32_t index, mandel_calculator_desc *desc);
+
+/**
+ * @brief Renders images around the given one with every calculator on one thread and stores
+ *        the times per point into the profile file used by mandel_select_calculator
+ *
+ * Measures the given size and limit, lower limits (1/16, 1/4) on the same size and higher
+ * ones (4x, 16x) on smaller images of about the same cost.
+ */
+mandel_status mandel_benchmark(const char *profile_path, uint32_t width, uint32_t height, uint32_t limit);
+
+/**
+ * @brief Picks the fastest calculator with exact results for the given image size and limit
+ *
+ * Compares the times stored by mandel_benchmark at the measured size and limit closest
+ * to the given ones, or the cost hints if the profile cannot be read.
+ *
+ * @param name receives the static name of the calculator
+ * @param from_profile if not NULL, set to 1 if the profile was used, 0 for the cost hints
+ */
+mandel_status mandel_select_calculator(const char *profile_path, uint32_t width, uint32_t height, uint32_t limit,
+                                       const char **name, int *from_profile);
+
+/** @brief Message of the last error of the context, empty if none. */
+const char *mandel_last_error(const mandel_context *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MANDEL_H
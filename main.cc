@@ -9,50 +9,571 @@
  * @date    24 September 2021, 11:07
  **/
 #include <iostream>
+#include <iomanip>
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <random>
+#include <memory>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "cxxopts.hpp"
 
 #include "cnpy.h"
 #include "vector_helpers.h"
+#include "result_compare.h"
+#include "image_output.h"
+#include "tile_pyramid.h"
 
-#include "RefMandelCalculator.h"
-#include "LineMandelCalculator.h"
-#include "BatchMandelCalculator.h"
+#include "mandel.h"
 
 using namespace std;
 
 /**
- * @brief Creates mandelbrot calculator object (template T), evaluates the
- *        speed, and prints output
+ * @brief Settings of one evaluation given on the command line
+ **/
+struct Evaluation
+{
+	std::string calculator;
+	unsigned baseSize;
+	unsigned iters;
+	unsigned threads;
+	std::string fileName;
+	bool batchMode;
+	bool compress;
+	std::string verifyReference;
+	unsigned verifySamples;
+	std::string tilesDir;
+	unsigned bandRows;
+	unsigned samples;
+	float threshold;
+	bool passes;
+	bool halfOutput;
+	mandel_huge_pages hugePages;
+
+	size_t width() const { return 3 * (size_t)baseSize; }
+	size_t height() const { return 2 * (size_t)baseSize; }
+};
+
+typedef std::unique_ptr<mandel_context, void (*)(mandel_context *)> ContextPtr;
+
+/**
+ * @brief Rows of the bands of --tiles without --band-rows, one row of tiles
+ **/
+static constexpr size_t tileBandRows = 256;
+
+/**
+ * @brief Throws if a libmandel call failed
+ **/
+static void check(const mandel_context *context, mandel_status status)
+{
+	if (status != MANDEL_OK)
+		throw std::runtime_error(std::string("libmandel: ") + mandel_status_string(status) + ": " + mandel_last_error(context));
+}
+
+/**
+ * @brief Creates a libmandel context of the given calculator for the evaluated image
+ **/
+static ContextPtr createContext(const std::string &calculator, const Evaluation &evaluation)
+{
+	mandel_context *context = NULL;
+	const mandel_status status = mandel_create(calculator.c_str(), &context);
+	if (status == MANDEL_UNKNOWN_CALCULATOR)
+		throw std::invalid_argument("Unknown calculator (" + calculator + ")");
+	check(context, status);
+
+	ContextPtr result(context, mandel_destroy);
+	check(context, mandel_set_size(context, evaluation.width(), evaluation.height()));
+	check(context, mandel_set_limit(context, evaluation.iters));
+	check(context, mandel_set_threads(context, evaluation.threads));
+	check(context, mandel_set_huge_pages(context, evaluation.hugePages));
+	return result;
+}
+
+/**
+ * @brief Allocates an output buffer of count elements with the huge page mode of the context
+ *
+ * The pages are first touched by the rendering threads.
  **/
 template <typename T>
-void evaluateCalculator(unsigned baseSize, unsigned iters, const std::string &fileName, bool batchMode)
+static T *allocOutput(const mandel_context *context, size_t count)
 {
-	T calculator(baseSize, iters);
+	T *buffer = static_cast<T *>(mandel_alloc_buffer(context, count * sizeof(T)));
+	if (!buffer)
+		throw std::bad_alloc();
+	return buffer;
+}
 
-	calculator.info(std::cout, batchMode);
+/**
+ * @brief Computes the result of the given reference calculator in-process and
+ *        compares it with data, the verdict goes to stderr in batch mode
+ **/
+bool verifyAgainst(const Evaluation &evaluation, const int *data)
+{
+	ContextPtr context = createContext(evaluation.verifyReference, evaluation);
+	std::vector<int32_t> referenceData(evaluation.height() * evaluation.width());
+	check(context.get(), mandel_render(context.get(), referenceData.data(), referenceData.size()));
 
-	auto startTime = PerfClock_t::now();
-	auto data = calculator.calculateMandelbrot();
-	auto elapsedTime = PerfClockDurationMs(PerfClock_t::now() - startTime).count();
+	std::ostream &out = evaluation.batchMode ? std::cerr : std::cout;
+	if (!evaluation.batchMode)
+		out << "Verification:      against " << evaluation.verifyReference << std::endl;
+
+	return compareResults(referenceData.data(), data, evaluation.height(), evaluation.width(), 20, out);
+}
+
+/**
+ * @brief Compares the given number of random points and both border rows of data
+ *        with the scalar reference algorithm, the verdict goes to stderr in batch mode
+ **/
+bool verifySample(mandel_context *context, const Evaluation &evaluation, const int *data)
+{
+	const size_t width = evaluation.width();
+	const size_t height = evaluation.height();
+
+	std::mt19937 generator(std::random_device{}());
+	std::uniform_int_distribution<size_t> row(0, height - 1);
+	std::uniform_int_distribution<size_t> column(0, width - 1);
+
+	const int iters = evaluation.iters;
+	size_t checked = 0, mismatches = 0, far = 0, invalid = 0;
+
+	auto check = [&](size_t i, size_t j) {
+		const int expected = mandel_reference_value(context, i, j);
+		const int actual = data[i * width + j];
+
+		checked++;
+		mismatches += (expected != actual);
+		far += (std::abs(expected - actual) > 1);
+		invalid += ((expected == iters) != (actual == iters));
+	};
+
+	for (size_t j = 0; j < width; j++)
+	{
+		check(0, j);
+		check(height - 1, j);
+	}
+
+	for (unsigned s = 0; s < evaluation.verifySamples; s++)
+		check(row(generator), column(generator));
+
+	// Same acceptance rule as compare.py. Its a.max() of a whole image is the limit, a sample
+	// may have no point in the set, so the membership is tested against the limit itself.
+	const bool valid = far == 0 || static_cast<double>(invalid) / checked < 0.001;
+
+	std::ostream &out = evaluation.batchMode ? std::cerr : std::cout;
+	out << "Sample check:      " << mismatches << " / " << checked << " mismatches ("
+		<< 100.0 * mismatches / checked << " %), " << (valid ? "ok" : "fail") << std::endl;
+
+	return valid;
+}
+
+/**
+ * @brief Writes size bytes at the given offset of the file
+ **/
+static void writeAt(int fd, const void *buffer, size_t size, size_t offset, const std::string &fileName)
+{
+	const char *bytes = static_cast<const char *>(buffer);
+	while (size > 0)
+	{
+		const ssize_t written = pwrite(fd, bytes, size, offset);
+		if (written < 0)
+			throw std::runtime_error("Unable to write " + fileName);
+		bytes += written;
+		size -= written;
+		offset += written;
+	}
+}
+
+/**
+ * @brief Render of the progressive passes reported by reportPass
+ **/
+struct PassOutput
+{
+	const Evaluation *evaluation;
+	PerfClock_t::time_point startTime;
+	size_t storedRows;
+};
+
+/**
+ * @brief Prints the time of a progressive pass and saves its preview next to the output image
+ **/
+static void reportPass(const int32_t *buffer, uint32_t stride, void *output)
+{
+	const PassOutput *pass = static_cast<const PassOutput *>(output);
+	const Evaluation &evaluation = *pass->evaluation;
+	auto elapsedTime = PerfClockDurationMs(PerfClock_t::now() - pass->startTime).count();
+
+	if (!evaluation.batchMode)
+		std::cout << "Pass " << std::left << std::setw(13) << std::to_string(stride) + ":" << elapsedTime << " ms" << std::endl;
 
+	// The final pass is the result saved as usual.
+	const std::string &fileName = evaluation.fileName;
+	if (stride > 1 && isImageFile(fileName))
+	{
+		const size_t extension = fileName.rfind('.');
+		const std::string preview = fileName.substr(0, extension) + ".pass" + std::to_string(stride) + fileName.substr(extension);
+		saveMirroredImage(preview, buffer, evaluation.height(), pass->storedRows, evaluation.width(), evaluation.iters);
+	}
+}
+
+/**
+ * @brief Prints the elapsed time, after the CSV prefix in batch mode
+ **/
+static void printElapsed(long long elapsedTime, bool batchMode)
+{
 	if (batchMode)
 		std::cout << elapsedTime << std::endl;
 	else
 	{
 		std::cout << "Elapsed Time:      " << elapsedTime << " ms" << std::endl;
 	}
+}
+
+/**
+ * @brief Prints the page faults of the last render, nothing in batch mode
+ **/
+static void printPageFaults(const mandel_context *context, bool batchMode)
+{
+	mandel_stats stats = {sizeof(mandel_stats)};
+	check(context, mandel_get_stats(context, &stats));
+
+	if (!batchMode)
+		std::cout << "Page faults:       " << stats.page_faults << std::endl;
+}
 
+/**
+ * @brief Parses the value of --huge-pages
+ **/
+static mandel_huge_pages parseHugePages(const std::string &mode)
+{
+	if (mode == "off")
+		return MANDEL_HUGE_PAGES_OFF;
+	if (mode == "thp")
+		return MANDEL_HUGE_PAGES_TRANSPARENT;
+	if (mode == "explicit")
+		return MANDEL_HUGE_PAGES_EXPLICIT;
+	throw std::invalid_argument("Unknown huge page mode (" + mode + ")");
+}
+
+/**
+ * @brief Renders rows [firstRow, firstRow + rows) of the image into band
+ *
+ * Rows below the middle are mirror images of the upper ones, a band reaching below it is
+ * rendered from the upper rows it mirrors (through window, of at least rows rows).
+ **/
+static void renderRows(mandel_context *context, const Evaluation &evaluation, size_t firstRow, size_t rows,
+                       std::vector<int32_t> &window, int32_t *band)
+{
+	const size_t height = evaluation.height();
+	const size_t width = evaluation.width();
+	const size_t upperRows = (height + 1) / 2;
+	const size_t endRow = firstRow + rows;
+
+	if (endRow <= upperRows)
+	{
+		check(context, mandel_set_row_window(context, firstRow, rows));
+		check(context, mandel_render(context, band, rows * width));
+		return;
+	}
+
+	// The upper rows of the band and the rows mirrored to its lower part are adjacent.
+	size_t sourceFirst = height - endRow;
+	size_t sourceEnd = height - std::max(firstRow, upperRows);
+	if (firstRow < upperRows)
+	{
+		sourceFirst = std::min(sourceFirst, firstRow);
+		sourceEnd = upperRows;
+	}
+
+	check(context, mandel_set_row_window(context, sourceFirst, sourceEnd - sourceFirst));
+	check(context, mandel_render(context, window.data(), window.size()));
+
+	for (size_t r = firstRow; r < endRow; r++)
+	{
+		const size_t source = r < upperRows ? r : height - r - 1;
+		std::copy(window.begin() + (source - sourceFirst) * width, window.begin() + (source - sourceFirst + 1) * width,
+		          band + (r - firstRow) * width);
+	}
+}
+
+/**
+ * @brief Out-of-core evaluation: the set is computed in bands of bandRows rows, so only
+ *        a few bands are ever held in memory
+ *
+ * Without tiles only the upper half is computed and every band is written to the .npy file
+ * together with its mirror image. Tiles need all rows in order, the bands are handed to
+ * a writer thread which encodes their tiles while the next band is rendered.
+ **/
+bool evaluateInBands(const Evaluation &evaluation)
+{
+	ContextPtr context = createContext(evaluation.calculator, evaluation);
+	const std::string &fileName = evaluation.fileName;
+	const size_t height = evaluation.height();
+	const size_t width = evaluation.width();
+	const size_t bandRows = evaluation.bandRows > 0 ? evaluation.bandRows : tileBandRows;
+
+	int fd = -1;
+	size_t dataOffset = 0;
 	if (fileName.length() > 0)
 	{
-		if(data == NULL)
-			std::cerr << "No data returned, skipping saving!" << std::endl;
+		fd = open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0)
+			throw std::runtime_error("Unable to open file " + fileName);
+
+		const std::vector<char> header = cnpy::create_npy_header<int>({height, width});
+		writeAt(fd, header.data(), header.size(), 0, fileName);
+		dataOffset = header.size();
+	}
+
+	std::unique_ptr<TilePyramid> pyramid;
+	std::unique_ptr<TileWriterThread> tileWriter;
+	if (evaluation.tilesDir.length() > 0)
+	{
+		pyramid.reset(new TilePyramid(evaluation.tilesDir, height, width, evaluation.iters));
+		tileWriter.reset(new TileWriterThread(*pyramid, bandRows, width));
+	}
+
+	std::cout << mandel_describe(context.get(), evaluation.batchMode);
+
+	// Bands without tiles are rendered into window, bands reaching below the middle go through it.
+	std::vector<int32_t> window(bandRows * width);
+
+	const size_t rowBytes = width * sizeof(int);
+	// Rows below the middle are mirror images of the rows above it.
+	const size_t upperRows = (height + 1) / 2;
+	const size_t renderedRows = pyramid ? height : upperRows;
+
+	auto startTime = PerfClock_t::now();
+	for (size_t firstRow = 0; firstRow < renderedRows; firstRow += bandRows)
+	{
+		const size_t rows = std::min(bandRows, renderedRows - firstRow);
+		int32_t *band = tileWriter ? tileWriter->band() : window.data();
+
+		renderRows(context.get(), evaluation, firstRow, rows, window, band);
+
+		if (fd >= 0)
+		{
+			writeAt(fd, band, rows * rowBytes, dataOffset + firstRow * rowBytes, fileName);
+			for (size_t r = 0; !pyramid && r < rows; r++)
+			{
+				const size_t mirrorRow = height - (firstRow + r) - 1;
+				if (mirrorRow != firstRow + r)
+					writeAt(fd, band + r * width, rowBytes, dataOffset + mirrorRow * rowBytes, fileName);
+			}
+		}
+
+		if (tileWriter)
+			tileWriter->push(rows);
+	}
+	auto elapsedTime = PerfClockDurationMs(PerfClock_t::now() - startTime).count();
+
+	if (fd >= 0)
+		close(fd);
+
+	printElapsed(elapsedTime, evaluation.batchMode);
+	if (!evaluation.batchMode)
+		std::cout << "Bands:             " << (renderedRows + bandRows - 1) / bandRows << " x " << bandRows << " rows" << std::endl;
+
+	if (tileWriter)
+	{
+		// The tiles of the last bands are still being written.
+		auto tilesStart = PerfClock_t::now();
+		tileWriter->finish();
+		pyramid->finish();
+		auto tilesTime = PerfClockDurationMs(PerfClock_t::now() - tilesStart).count();
+
+		if (!evaluation.batchMode)
+			std::cout << "Tiles:             " << pyramid->tilesWritten() << " in " << pyramid->levels() << " levels (" << evaluation.tilesDir
+			          << "), " << tilesTime << " ms after the render" << std::endl;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Anti-aliased evaluation: every pixel averages the smooth iteration count
+ *        of samples x samples subsamples, the output holds the float averages
+ **/
+bool evaluateSupersampled(const Evaluation &evaluation)
+{
+	ContextPtr context = createContext(evaluation.calculator, evaluation);
+	check(context.get(), mandel_set_supersampling(context.get(), evaluation.samples, evaluation.threshold));
+
+	const std::string &fileName = evaluation.fileName;
+	const std::vector<size_t> shape = {evaluation.height(), evaluation.width()};
+	std::unique_ptr<float, void (*)(void *)> smooth(allocOutput<float>(context.get(), evaluation.height() * evaluation.width()), mandel_free_buffer);
+
+	std::cout << mandel_describe(context.get(), evaluation.batchMode);
+
+	auto startTime = PerfClock_t::now();
+	check(context.get(), mandel_render_smooth(context.get(), smooth.get(), evaluation.height() * evaluation.width()));
+	auto elapsedTime = PerfClockDurationMs(PerfClock_t::now() - startTime).count();
+
+	printElapsed(elapsedTime, evaluation.batchMode);
+	printPageFaults(context.get(), evaluation.batchMode);
+
+	if (evaluation.threshold > 0.0f)
+	{
+		mandel_stats stats = {sizeof(mandel_stats)};
+		check(context.get(), mandel_get_stats(context.get(), &stats));
+
+		std::ostream &out = evaluation.batchMode ? std::cerr : std::cout;
+		out << "Refined pixels:    " << 100.0 * stats.refined_fraction << " %" << std::endl;
+	}
+
+	if (fileName.length() > 0)
+	{
+		if (isImageFile(fileName))
+			saveImage(fileName, smooth.get(), shape[0], shape[1], evaluation.iters);
+		else if (fileName.compare(fileName.size() - 4, 4, ".npy") == 0)
+			cnpy::npy_save(fileName, smooth.get(), shape);
+		else if (evaluation.compress)
+			cnpy::npz_save_compressed(fileName, "d", smooth.get(), shape, "wb");
 		else
-			cnpy::npz_save(fileName, "d", data, {(size_t)calculator.height, (size_t)calculator.width}, "wb");
+			cnpy::npz_save(fileName, "d", smooth.get(), shape, "wb");
 	}
+
+	return true;
+}
+
+/**
+ * @brief Creates mandelbrot calculator context, evaluates the speed, and prints output
+ *
+ * @return false if the verification against the reference failed
+ **/
+bool evaluateCalculator(const Evaluation &evaluation)
+{
+	if (evaluation.bandRows > 0 || evaluation.tilesDir.length() > 0)
+		return evaluateInBands(evaluation);
+	if (evaluation.samples > 0)
+		return evaluateSupersampled(evaluation);
+
+	ContextPtr context = createContext(evaluation.calculator, evaluation);
+	const std::string &fileName = evaluation.fileName;
+	const size_t height = evaluation.height();
+	const size_t width = evaluation.width();
+
+	// With --half only the upper half of the symmetric image is kept, the writers mirror the rest
+	mandel_output_layout layout = {sizeof(mandel_output_layout)};
+	check(context.get(), mandel_set_half_output(context.get(), evaluation.halfOutput));
+	check(context.get(), mandel_get_output_layout(context.get(), &layout));
+	const size_t storedRows = layout.stored_rows;
+
+	// .npy output is mapped into memory and the calculator computes directly into it
+	std::unique_ptr<cnpy::MappedNpyFile> mappedOutput;
+	std::unique_ptr<int, void (*)(void *)> buffer(NULL, mandel_free_buffer);
+	int *data;
+	const bool mapOutput = fileName.size() > 4 && fileName.compare(fileName.size() - 4, 4, ".npy") == 0;
+	if (mapOutput)
+	{
+		mappedOutput = cnpy::npy_create_mapped<int>(fileName, {height, width});
+		data = mappedOutput->data<int>();
+	}
+	else
+	{
+		buffer.reset(allocOutput<int>(context.get(), storedRows * width));
+		data = buffer.get();
+	}
+
+	std::cout << mandel_describe(context.get(), evaluation.batchMode);
+	if (!evaluation.batchMode && storedRows < height)
+		std::cout << "Stored rows:       " << storedRows << " of " << height << " (mirrored on output)" << std::endl;
+
+	auto startTime = PerfClock_t::now();
+	PassOutput passOutput = {&evaluation, startTime, storedRows};
+	if (evaluation.passes)
+		check(context.get(), mandel_set_pass_callback(context.get(), reportPass, &passOutput));
+	check(context.get(), mandel_render(context.get(), data, storedRows * width));
+	auto elapsedTime = PerfClockDurationMs(PerfClock_t::now() - startTime).count();
+
+	printElapsed(elapsedTime, evaluation.batchMode);
+	printPageFaults(context.get(), evaluation.batchMode);
+
+	if (fileName.length() > 0 && !mapOutput)
+	{
+		if (isImageFile(fileName))
+			saveMirroredImage(fileName, data, height, storedRows, width, evaluation.iters);
+		else if (evaluation.compress)
+			cnpy::npz_save_compressed_mirrored(fileName, "d", data, {height, width}, storedRows, "wb");
+		else
+			cnpy::npz_save_mirrored(fileName, "d", data, {height, width}, storedRows, "wb");
+	}
+
+	bool valid = true;
+
+	if (evaluation.verifySamples > 0)
+		valid = verifySample(context.get(), evaluation, data) && valid;
+
+	if (evaluation.verifyReference.length() > 0)
+		valid = verifyAgainst(evaluation, data) && valid;
+
+	return valid;
+}
+
+/**
+ * @brief Names of all calculators for the help of -c
+ **/
+static std::string calculatorNames()
+{
+	std::string names;
+	mandel_calculator_desc desc = {sizeof(mandel_calculator_desc)};
+	for (uint32_t i = 0; i < mandel_calculator_count(); i++)
+	{
+		mandel_calculator_info(i, &desc);
+		names += std::string(desc.name) + ", ";
+	}
+	return names + "auto";
+}
+
+/**
+ * @brief Prints the calculators with their capabilities, CSV in batch mode
+ **/
+static void listCalculators(bool batchMode)
+{
+	mandel_calculator_desc desc = {sizeof(mandel_calculator_desc)};
+	for (uint32_t i = 0; i < mandel_calculator_count(); i++)
+	{
+		mandel_calculator_info(i, &desc);
+
+		std::string capabilities;
+		if (desc.capabilities & MANDEL_CAP_THREADS)
+			capabilities += "threads ";
+		if (desc.capabilities & MANDEL_CAP_EXACT)
+			capabilities += "exact ";
+		if (desc.capabilities & MANDEL_CAP_SIMD)
+			capabilities += "simd ";
+		if (desc.capabilities & MANDEL_CAP_SMOOTH)
+			capabilities += "smooth ";
+		if (!capabilities.empty())
+			capabilities.pop_back();
+
+		if (batchMode)
+			std::cout << desc.name << ";" << capabilities << ";" << desc.precision << ";" << desc.dtype << ";"
+			          << desc.isa << ";" << desc.cost_hint << std::endl;
+		else
+			std::cout << std::left << std::setw(14) << desc.name << desc.description << std::endl
+			          << std::setw(14) << "" << "capabilities: " << capabilities << std::endl
+			          << std::setw(14) << "" << "precision: " << desc.precision << ", dtype: " << desc.dtype
+			          << ", isa: " << desc.isa << ", cost hint: " << desc.cost_hint << std::endl;
+	}
+}
+
+/**
+ * @brief Resolves -c auto to the fastest exact calculator of the stored profile for the evaluated image
+ **/
+static std::string selectCalculator(const std::string &profile, const Evaluation &evaluation)
+{
+	const char *name;
+	int fromProfile;
+	if (mandel_select_calculator(profile.c_str(), evaluation.width(), evaluation.height(), evaluation.iters, &name, &fromProfile) != MANDEL_OK)
+		throw std::invalid_argument("No calculator to select");
+
+	std::ostream &out = evaluation.batchMode ? std::cerr : std::cout;
+	out << "Selected calculator: " << name << (fromProfile ? " (profile " + profile + ")" : std::string(" (cost hints)")) << std::endl;
+	return name;
 }
 
 int main(int argc, char *argv[])
@@ -61,10 +582,24 @@ int main(int argc, char *argv[])
 	// Initialize CXXOPTS library used to parse command line arguments
 	cxxopts::Options options("AVS: Mandelbrot", "AVS Assignment 1 - Mandelbrot calculation using SIMD instructions");
 	options.add_options()
-		("o,output", "Output numpy file", cxxopts::value<std::string>()->default_value(""))
+		("o,output", "Output file (.npz, .npy written in place through mmap, or .png/.ppm image)", cxxopts::value<std::string>()->default_value(""))
 		("s,size", "Base matrix size", cxxopts::value<unsigned>()->default_value("2048"))
 		("i,iters", "Number of iterations", cxxopts::value<unsigned>()->default_value("100"))
-		("c,calculator", "Calculator name [ref, batch, line]", cxxopts::value<std::string>()->default_value("ref"))
+		("c,calculator", "Calculator name [" + calculatorNames() + "]", cxxopts::value<std::string>()->default_value("ref"))
+		("list-calculators", "List the calculators with their capabilities and exit")
+		("profile", "Benchmark profile used by -c auto", cxxopts::value<std::string>()->default_value("mandelbrot_profile.csv"))
+		("benchmark", "Time all calculators on the given image and at lower and higher limits, store the profile and exit")
+		("t,threads", "Number of rendering threads (0 = all hardware threads)", cxxopts::value<unsigned>()->default_value("1"))
+		("z,compress", "Deflate the output numpy file (np.savez_compressed)")
+		("verify-against", "Verify the result against an in-process run of the given calculator", cxxopts::value<std::string>()->default_value(""))
+		("verify-sample", "Check this many random points and the border rows with the reference algorithm", cxxopts::value<unsigned>()->default_value("0"))
+		("tiles", "Write a pyramid of 256x256 PNG tiles of all zoom levels into this directory, rendered in bands (.npy output only)", cxxopts::value<std::string>()->default_value(""))
+		("band-rows", "Out-of-core mode: compute and stream the result (and --tiles) in bands of this many rows (.npy output only)", cxxopts::value<unsigned>()->default_value("0"))
+		("aa", "Anti-aliasing: average the smooth iteration count of N x N subsamples per pixel (float output, replaces -c)", cxxopts::value<unsigned>()->default_value("0"))
+		("aa-threshold", "Adaptive anti-aliasing: supersample only pixels differing from a neighbour by more than this many iterations", cxxopts::value<float>()->default_value("0"))
+		("half", "Keep only the upper half of the symmetric image in memory, the output writers mirror the rest (.npz/.png/.ppm output)")
+		("huge-pages", "Page size of the output and scratch buffers: off, thp (2 MiB transparent huge pages) or explicit (hugetlbfs pool)", cxxopts::value<std::string>()->default_value("off"))
+		("passes", "With -c progressive on one thread: print the time of every pass and save its preview next to the output image (name.pass8.png, ...)")
 		("batch", "Run in silent/batch mode")
 		("h,help", "Print help");
 
@@ -82,30 +617,97 @@ int main(int argc, char *argv[])
 			std::exit(0);
 		}
 
-		const std::string calculator = args["calculator"].as<std::string>();
-		if (calculator == "ref")
+		if (args.count("list-calculators"))
 		{
-			evaluateCalculator<RefMandelCalculator>(args["size"].as<unsigned>(), args["iters"].as<unsigned>(), args["output"].as<std::string>(), args.count("batch"));
+			listCalculators(args.count("batch"));
+			std::exit(0);
 		}
-		else if (calculator == "line")
+
+		const std::string profile = args["profile"].as<std::string>();
+
+		Evaluation evaluation;
+		evaluation.calculator = args["calculator"].as<std::string>();
+		evaluation.baseSize = args["size"].as<unsigned>();
+		evaluation.iters = args["iters"].as<unsigned>();
+		evaluation.threads = args["threads"].as<unsigned>();
+		evaluation.fileName = args["output"].as<std::string>();
+		evaluation.batchMode = args.count("batch");
+		evaluation.compress = args.count("compress");
+		evaluation.verifyReference = args["verify-against"].as<std::string>();
+		evaluation.verifySamples = args["verify-sample"].as<unsigned>();
+		evaluation.tilesDir = args["tiles"].as<std::string>();
+		evaluation.bandRows = args["band-rows"].as<unsigned>();
+		evaluation.samples = args["aa"].as<unsigned>();
+		evaluation.threshold = args["aa-threshold"].as<float>();
+		evaluation.passes = args.count("passes");
+		evaluation.halfOutput = args.count("half");
+		evaluation.hugePages = parseHugePages(args["huge-pages"].as<std::string>());
+
+		if (args.count("benchmark"))
 		{
-			evaluateCalculator<LineMandelCalculator>(args["size"].as<unsigned>(), args["iters"].as<unsigned>(), args["output"].as<std::string>(), args.count("batch"));
+			if (mandel_benchmark(profile.c_str(), evaluation.width(), evaluation.height(), evaluation.iters) != MANDEL_OK)
+			{
+				std::cerr << "Cannot write the profile " << profile << std::endl;
+				std::exit(1);
+			}
+			std::cout << "Profile written:   " << profile << std::endl;
+			std::exit(0);
 		}
-		else if (calculator == "batch")
+
+		if (evaluation.calculator == "auto")
+			evaluation.calculator = selectCalculator(profile, evaluation);
+
+		const bool verification = evaluation.verifyReference.length() > 0 || evaluation.verifySamples > 0;
+
+		if (evaluation.bandRows > 0 || evaluation.tilesDir.length() > 0)
 		{
-			evaluateCalculator<BatchMandelCalculator>(args["size"].as<unsigned>(), args["iters"].as<unsigned>(), args["output"].as<std::string>(), args.count("batch"));
+			const std::string &output = evaluation.fileName;
+			const bool npyOutput = output.size() > 4 && output.compare(output.size() - 4, 4, ".npy") == 0;
+
+			if ((output.length() > 0 && !npyOutput) || evaluation.compress || verification || evaluation.passes)
+			{
+				std::cerr << "--band-rows and --tiles render in bands, they write only .npy output and cannot be combined with -z, --passes or verification" << std::endl;
+				std::exit(1);
+			}
 		}
-		else
+
+		if (evaluation.samples > 0 && (evaluation.bandRows > 0 || evaluation.tilesDir.length() > 0 || verification))
 		{
-			std::cerr << "Unknown calculator (" << calculator << ")" << std::endl;
+			std::cerr << "--aa cannot be combined with --band-rows, --tiles or verification" << std::endl;
 			std::exit(1);
 		}
+
+		if (evaluation.halfOutput)
+		{
+			const std::string &output = evaluation.fileName;
+			const bool npyOutput = output.size() > 4 && output.compare(output.size() - 4, 4, ".npy") == 0;
+
+			if (npyOutput || evaluation.bandRows > 0 || evaluation.samples > 0 || evaluation.tilesDir.length() > 0 || verification)
+			{
+				std::cerr << "--half cannot be combined with .npy output, --band-rows, --aa, --tiles or verification" << std::endl;
+				std::exit(1);
+			}
+		}
+
+		if (!evaluateCalculator(evaluation))
+			std::exit(1);
 	}
 	catch (const cxxopts::OptionException &e)
 	{
 		std::cerr << "Invalid options specified: " << e.what() << std::endl;
 		std::exit(1);
 	}
+	catch (const std::bad_alloc &)
+	{
+		std::cerr << "Out of memory" << std::endl;
+		std::exit(1);
+	}
+	catch (const std::exception &e)
+	{
+		// std::invalid_argument for bad option values, libmandel and file errors
+		std::cerr << e.what() << std::endl;
+		std::exit(1);
+	}
 
 	return 0;
 }
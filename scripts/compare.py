@@ -4,6 +4,13 @@ import numpy as np
 import argparse
 
 
+def load(filename):
+    # .npy files are mapped, so large renders are not read into memory up front
+    if filename.endswith(".npy"):
+        return np.load(filename, mmap_mode="r")
+    return np.load(filename)["d"]
+
+
 def main(file1=None, file2=None):
 
     fail = "[\033[91mfail\033[0m]"
@@ -11,13 +18,13 @@ def main(file1=None, file2=None):
 
 
     try:
-        a1 = np.load(file1)["d"]
+        a1 = load(file1)
     except Exception as e:
         print(f"{fail} Error during loading {file1}: {e}")
         return False
 
     try:
-        a2 = np.load(file2)["d"]
+        a2 = load(file2)
     except Exception as e:
         print(f"{fail} Error during loading {file2}: {e}")
         return False
@@ -60,7 +67,7 @@ def main(file1=None, file2=None):
 
 
 if __name__ == "__main__":
-    parser = argparse.ArgumentParser(description="Compare two npz files")
+    parser = argparse.ArgumentParser(description="Compare two npz (or npy) files")
     parser.add_argument("file1", type=str)
     parser.add_argument("file2", type=str)
 
@@ -1,22 +1,35 @@
 
 
 SCRIPT_ROOT_PATH="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null && pwd )"
-CALCULATORS=("ref" "line" "batch")
+CALCULATORS=("ref" "line" "batch" "deferred" "interleaved" "fixed")
 
 for calc in "${CALCULATORS[@]}"; do
     ./mandelbrot -s 512 -i 100 -c $calc --batch cmp_$calc.npz
 done
 
+# Prefer the native comparison tool built next to mandelbrot
+COMPARE="python3 ${SCRIPT_ROOT_PATH}/compare.py"
+[ -x ./mandelbrot_compare ] && COMPARE="./mandelbrot_compare"
+
 VALID=1
 echo "Reference vs line"
-python3 ${SCRIPT_ROOT_PATH}/compare.py cmp_ref.npz cmp_line.npz  || VALID=0
+${COMPARE} cmp_ref.npz cmp_line.npz  || VALID=0
 
 echo "Reference vs batch"
-python3 ${SCRIPT_ROOT_PATH}/compare.py cmp_ref.npz cmp_batch.npz || VALID=0
+${COMPARE} cmp_ref.npz cmp_batch.npz || VALID=0
+
+echo "Reference vs deferred"
+${COMPARE} cmp_ref.npz cmp_deferred.npz || VALID=0
+
+echo "Reference vs interleaved"
+${COMPARE} cmp_ref.npz cmp_interleaved.npz || VALID=0
+
+echo "Reference vs fixed"
+${COMPARE} cmp_ref.npz cmp_fixed.npz || VALID=0
 
 
 echo "Batch vs line"
-python3 ${SCRIPT_ROOT_PATH}/compare.py cmp_line.npz cmp_batch.npz || VALID=0
+${COMPARE} cmp_line.npz cmp_batch.npz || VALID=0
 
 if [ "$VALID" -eq 1 ]; then
     echo "Test passed";
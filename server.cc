@@ -0,0 +1,516 @@
+/**
+ * @file    server.cc
+ *
+ * @author  David Chocholaty <xchoch09@stud.fit.vutbr.cz>
+ *
+ * @brief   Local render server - keeps the calculators warm behind a Unix domain socket
+ *
+ *          Protocol: one request per line, any number of requests per connection
+ *
+ *            render X_MIN X_MAX Y_MIN Y_MAX WIDTH HEIGHT LIMIT [int32|float32] [raw|npy]
+ *            stats
+ *
+ *          A render is answered by "ok BYTES\n" followed by BYTES of row-major
+ *          little-endian values (raw, default) or of a .npy file (npy), stats by
+ *          "ok BYTES\n" and a text line, errors by "error MESSAGE\n".
+ *
+ *          int32 renders of at most --batch-pixels points waiting at the same
+ *          time with the same limit are computed together in one pass of the
+ *          batch kernel, so small tiles fill whole SIMD blocks.
+ *
+ * @date    19 October 2026
+ **/
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "cxxopts.hpp"
+
+#include "cnpy.h"
+#include "BatchMandelCalculator.h"
+
+#include "mandel.h"
+
+/**
+ * @brief Parameters of one render request
+ **/
+struct RenderRequest
+{
+	double xMin, xMax, yMin, yMax;
+	unsigned width;
+	unsigned height;
+	unsigned limit;
+	bool smooth; // float32 smooth iteration counts instead of int32 ones
+	bool npy; // answer with a .npy file instead of the raw values
+
+	size_t pixels() const { return static_cast<size_t>(width) * height; }
+};
+
+/**
+ * @brief A request waiting for a worker, output has room for width * height values
+ **/
+struct RenderJob
+{
+	RenderRequest request;
+	void *output;
+	std::string error; // empty if the render succeeded
+	bool done;
+};
+
+/**
+ * @brief Pool of warm worker threads rendering the queued jobs
+ **/
+class RenderServer
+{
+public:
+	RenderServer(const std::string &calculator, unsigned workers, size_t batchPixels);
+	~RenderServer();
+
+	/**
+	 * @brief Queues the job and waits until a worker renders it
+	 **/
+	void render(RenderJob &job);
+
+	bool batchable(const RenderRequest &request) const
+	{
+		return !request.smooth && request.pixels() <= batchPixels;
+	}
+
+	std::string stats() const;
+
+private:
+	/**
+	 * @brief Scratch buffers of one worker, allocated once for the largest batch
+	 **/
+	struct Scratch
+	{
+		std::vector<float> real;
+		std::vector<float> imag;
+		std::vector<int> result;
+	};
+
+	void work();
+
+	/**
+	 * @brief Computes the points of all jobs together and copies the counts back to the jobs
+	 **/
+	void renderBatch(const std::vector<RenderJob *> &jobs, Scratch &scratch);
+
+	/**
+	 * @brief Renders a large (or smooth) job on its own with the context of the worker
+	 **/
+	void renderSingle(RenderJob &job, mandel_context *context);
+
+	const std::string calculator;
+	const size_t batchPixels;
+
+	std::mutex mutex;
+	std::condition_variable queued;
+	std::condition_variable finished;
+	std::deque<RenderJob *> queue;
+	bool stopping;
+	std::vector<std::thread> workers;
+
+	std::atomic<unsigned long long> renders;
+	std::atomic<unsigned long long> batches;
+	std::atomic<unsigned long long> batchedRenders;
+};
+
+RenderServer::RenderServer(const std::string &calculator, unsigned workers, size_t batchPixels)
+	: calculator(calculator), batchPixels(batchPixels), stopping(false), renders(0), batches(0), batchedRenders(0)
+{
+	for (unsigned i = 0; i < workers; i++)
+		this->workers.emplace_back(&RenderServer::work, this);
+}
+
+RenderServer::~RenderServer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	queued.notify_all();
+
+	for (std::thread &worker : workers)
+		worker.join();
+}
+
+void RenderServer::render(RenderJob &job)
+{
+	job.done = false;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	queue.push_back(&job);
+	queued.notify_one();
+	finished.wait(lock, [&job]() { return job.done; });
+}
+
+std::string RenderServer::stats() const
+{
+	std::ostringstream out;
+	out << "renders " << renders << " batches " << batches << " batched_renders " << batchedRenders
+	    << " workers " << workers.size() << "\n";
+	return out.str();
+}
+
+void RenderServer::work()
+{
+	mandel_context *context;
+	if (mandel_create(calculator.c_str(), &context) != MANDEL_OK)
+		throw std::invalid_argument("Unknown calculator (" + calculator + ")");
+
+	Scratch scratch;
+	scratch.real.resize(batchPixels);
+	scratch.imag.resize(batchPixels);
+	scratch.result.resize(batchPixels);
+
+	std::vector<RenderJob *> jobs;
+
+	for (;;)
+	{
+		jobs.clear();
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			queued.wait(lock, [this]() { return stopping || !queue.empty(); });
+			if (stopping)
+				break;
+
+			jobs.push_back(queue.front());
+			queue.pop_front();
+
+			// Other small tiles of the same limit waiting now join the batch.
+			const RenderRequest &first = jobs.front()->request;
+			if (batchable(first))
+			{
+				size_t pixels = first.pixels();
+				for (auto it = queue.begin(); it != queue.end();)
+				{
+					const RenderRequest &request = (*it)->request;
+					if (batchable(request) && request.limit == first.limit && pixels + request.pixels() <= batchPixels)
+					{
+						pixels += request.pixels();
+						jobs.push_back(*it);
+						it = queue.erase(it);
+					}
+					else
+						++it;
+				}
+			}
+		}
+
+		if (batchable(jobs.front()->request))
+			renderBatch(jobs, scratch);
+		else
+			renderSingle(*jobs.front(), context);
+
+		renders += jobs.size();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (RenderJob *job : jobs)
+				job->done = true;
+		}
+		finished.notify_all();
+	}
+
+	mandel_destroy(context);
+}
+
+void RenderServer::renderBatch(const std::vector<RenderJob *> &jobs, Scratch &scratch)
+{
+	// The points are computed the same way as by the calculators, so are the counts.
+	size_t count = 0;
+	for (const RenderJob *job : jobs)
+	{
+		const RenderRequest &request = job->request;
+		const double dx = (request.xMax - request.xMin) / (request.width - 1);
+		const double dy = (request.yMax - request.yMin) / (request.height - 1);
+
+		for (unsigned i = 0; i < request.height; i++)
+		{
+			const float y = static_cast<float>(request.yMin + i * dy);
+			for (unsigned j = 0; j < request.width; j++, count++)
+			{
+				scratch.real[count] = static_cast<float>(request.xMin + j * dx);
+				scratch.imag[count] = y;
+			}
+		}
+	}
+
+	BatchMandelCalculator::calculatePoints(scratch.real.data(), scratch.imag.data(), scratch.result.data(), count, jobs.front()->request.limit);
+
+	const int *result = scratch.result.data();
+	for (RenderJob *job : jobs)
+	{
+		std::memcpy(job->output, result, job->request.pixels() * sizeof(int));
+		result += job->request.pixels();
+	}
+
+	batches++;
+	if (jobs.size() > 1)
+		batchedRenders += jobs.size();
+}
+
+void RenderServer::renderSingle(RenderJob &job, mandel_context *context)
+{
+	const RenderRequest &request = job.request;
+
+	mandel_status status = mandel_set_size(context, request.width, request.height);
+	if (status == MANDEL_OK)
+		status = mandel_set_viewport(context, request.xMin, request.xMax, request.yMin, request.yMax);
+	if (status == MANDEL_OK)
+		status = mandel_set_limit(context, request.limit);
+	if (status == MANDEL_OK)
+		status = mandel_set_supersampling(context, request.smooth ? 1 : 0, 0.0f);
+	if (status == MANDEL_OK)
+	{
+		if (request.smooth)
+			status = mandel_render_smooth(context, static_cast<float *>(job.output), request.pixels());
+		else
+			status = mandel_render(context, static_cast<int32_t *>(job.output), request.pixels());
+	}
+
+	if (status != MANDEL_OK)
+		job.error = std::string(mandel_status_string(status)) + ": " + mandel_last_error(context);
+}
+
+/**
+ * @brief Parses a render request line, throws std::invalid_argument if it is malformed
+ **/
+static RenderRequest parseRequest(std::istringstream &in, size_t maxPixels)
+{
+	RenderRequest request;
+	std::string dtype = "int32";
+	std::string format = "raw";
+
+	if (!(in >> request.xMin >> request.xMax >> request.yMin >> request.yMax >> request.width >> request.height >> request.limit))
+		throw std::invalid_argument("expected: render X_MIN X_MAX Y_MIN Y_MAX WIDTH HEIGHT LIMIT [int32|float32] [raw|npy]");
+	in >> dtype >> format;
+
+	if (!std::isfinite(request.xMin) || !std::isfinite(request.xMax) || !std::isfinite(request.yMin) || !std::isfinite(request.yMax))
+		throw std::invalid_argument("viewport is not finite");
+	if (request.width < 2 || request.height < 2 || request.limit < 1)
+		throw std::invalid_argument("size has to be at least 2x2 and limit at least 1");
+	// The iteration counts are int32, a negative limit is read as a large unsigned one too.
+	if (request.limit > INT32_MAX)
+		throw std::invalid_argument("limit larger than " + std::to_string(INT32_MAX));
+	if (request.pixels() > maxPixels)
+		throw std::invalid_argument("image larger than " + std::to_string(maxPixels) + " pixels");
+	if (dtype != "int32" && dtype != "float32")
+		throw std::invalid_argument("unknown dtype " + dtype);
+	if (format != "raw" && format != "npy")
+		throw std::invalid_argument("unknown format " + format);
+
+	request.smooth = dtype == "float32";
+	request.npy = format == "npy";
+	return request;
+}
+
+/**
+ * @brief Sends the whole buffer, false if the client went away
+ **/
+static bool sendAll(int fd, const char *data, size_t size)
+{
+	while (size > 0)
+	{
+		const ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+		if (sent <= 0)
+			return false;
+		data += sent;
+		size -= sent;
+	}
+	return true;
+}
+
+static bool sendLine(int fd, const std::string &line)
+{
+	return sendAll(fd, line.data(), line.size());
+}
+
+/**
+ * @brief Serves the requests of one connection until the client closes it
+ **/
+static void serveConnection(int fd, RenderServer &server, size_t maxPixels)
+{
+	// The response buffer of the connection is reused by all its requests.
+	std::vector<char> response;
+	std::string pending;
+	char chunk[4096];
+
+	for (;;)
+	{
+		const size_t newline = pending.find('\n');
+		if (newline == std::string::npos)
+		{
+			const ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+			if (received <= 0)
+				break;
+			pending.append(chunk, received);
+			continue;
+		}
+
+		std::istringstream in(pending.substr(0, newline));
+		pending.erase(0, newline + 1);
+
+		std::string command;
+		in >> command;
+
+		bool connected = true;
+		if (command == "render")
+		{
+			try
+			{
+				RenderJob job;
+				job.request = parseRequest(in, maxPixels);
+
+				const size_t dataBytes = job.request.pixels() * (job.request.smooth ? sizeof(float) : sizeof(int32_t));
+				// The .npy header is a multiple of 16 bytes, the values after it stay aligned.
+				const std::vector<char> header = !job.request.npy ? std::vector<char>() :
+					job.request.smooth ? cnpy::create_npy_header<float>({job.request.height, job.request.width}) :
+					                     cnpy::create_npy_header<int32_t>({job.request.height, job.request.width});
+
+				response.resize(header.size() + dataBytes);
+				std::copy(header.begin(), header.end(), response.begin());
+				job.output = response.data() + header.size();
+
+				server.render(job);
+
+				if (job.error.empty())
+					connected = sendLine(fd, "ok " + std::to_string(response.size()) + "\n") && sendAll(fd, response.data(), response.size());
+				else
+					connected = sendLine(fd, "error " + job.error + "\n");
+			}
+			catch (const std::invalid_argument &e)
+			{
+				connected = sendLine(fd, std::string("error ") + e.what() + "\n");
+			}
+			catch (const std::bad_alloc &)
+			{
+				connected = sendLine(fd, "error out of memory\n");
+			}
+		}
+		else if (command == "stats")
+		{
+			const std::string stats = server.stats();
+			connected = sendLine(fd, "ok " + std::to_string(stats.size()) + "\n" + stats);
+		}
+		else if (!command.empty())
+			connected = sendLine(fd, "error unknown command " + command + "\n");
+
+		if (!connected)
+			break;
+	}
+
+	close(fd);
+}
+
+static char socketPath[sizeof(sockaddr_un::sun_path)];
+
+static void removeSocket(int)
+{
+	unlink(socketPath);
+	_exit(0);
+}
+
+int main(int argc, char *argv[])
+{
+	cxxopts::Options options("mandelbrot_server", "Renders Mandelbrot set tiles requested over a Unix domain socket");
+	options.add_options()
+		("socket", "Path of the Unix domain socket", cxxopts::value<std::string>()->default_value("/tmp/mandelbrot.sock"))
+		("c,calculator", "Calculator of the renders too large to be batched", cxxopts::value<std::string>()->default_value("batch"))
+		("t,threads", "Number of worker threads (0 = all hardware threads)", cxxopts::value<unsigned>()->default_value("0"))
+		("batch-pixels", "Largest render batched with other ones, also the size of one batch", cxxopts::value<unsigned>()->default_value("65536"))
+		("max-pixels", "Largest accepted render", cxxopts::value<unsigned>()->default_value("67108864"))
+		("h,help", "Print help");
+
+	try
+	{
+		auto args = options.parse(argc, argv);
+
+		if (args.count("help"))
+		{
+			std::cout << options.help() << std::endl;
+			std::exit(0);
+		}
+
+		const std::string path = args["socket"].as<std::string>();
+		const std::string calculator = args["calculator"].as<std::string>();
+		const size_t batchPixels = args["batch-pixels"].as<unsigned>();
+		const size_t maxPixels = args["max-pixels"].as<unsigned>();
+		unsigned threads = args["threads"].as<unsigned>();
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+
+		mandel_context *context;
+		if (mandel_create(calculator.c_str(), &context) != MANDEL_OK)
+			throw std::invalid_argument("Unknown calculator (" + calculator + ")");
+		mandel_destroy(context);
+
+		if (path.size() >= sizeof(socketPath))
+			throw std::invalid_argument("Socket path too long (" + path + ")");
+		std::strcpy(socketPath, path.c_str());
+
+		const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+		sockaddr_un address = {};
+		address.sun_family = AF_UNIX;
+		std::strcpy(address.sun_path, socketPath);
+
+		unlink(socketPath);
+		if (listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(listener, 64) != 0)
+		{
+			std::cerr << "Cannot listen on " << path << ": " << std::strerror(errno) << std::endl;
+			std::exit(1);
+		}
+
+		std::signal(SIGINT, removeSocket);
+		std::signal(SIGTERM, removeSocket);
+
+		RenderServer server(calculator, threads, batchPixels);
+		std::cout << "Listening on " << path << " with " << threads << " workers" << std::endl;
+
+		for (;;)
+		{
+			const int fd = accept(listener, NULL, NULL);
+			if (fd < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				std::cerr << "accept: " << std::strerror(errno) << std::endl;
+				break;
+			}
+
+			std::thread(serveConnection, fd, std::ref(server), maxPixels).detach();
+		}
+
+		unlink(socketPath);
+	}
+	catch (const cxxopts::OptionException &e)
+	{
+		std::cerr << "Invalid options specified: " << e.what() << std::endl;
+		std::exit(1);
+	}
+	catch (const std::invalid_argument &e)
+	{
+		std::cerr << e.what() << std::endl;
+		std::exit(1);
+	}
+
+	return 0;
+}